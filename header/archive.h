@@ -0,0 +1,48 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "pack_format.h"
+
+const char* const ASSET_ARCHIVE_NAME = "assets.pak";
+
+// Read-only view of an assets.pak built by tools/pack.cpp. The file is
+// memory-mapped once; raw entries are served straight from the mapping and
+// zstd entries are decompressed on first use and kept for the archive's life.
+// Those buffers count toward decompressedBytes(), not the texture budget.
+// openEntry() is safe to call from any thread; each entry is decompressed
+// exactly once however many threads ask for it.
+class AssetArchive {
+public:
+    AssetArchive() = default;
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+    ~AssetArchive();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    const PackEntry* find(const std::string& name) const;
+    SDL_RWops* openEntry(const std::string& name);
+    size_t decompressedBytes() const { return decompressedTotal.load(std::memory_order_relaxed); }
+
+private:
+    bool map(const std::string& path);
+    void unmap();
+
+    const Uint8* base = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+    const PackEntry* entries = nullptr;
+    Uint32 entryCount = 0;
+    std::vector<std::vector<Uint8>> decompressed;
+    std::unique_ptr<std::once_flag[]> decompressOnce;
+    std::atomic<size_t> decompressedTotal{0};
+};
@@ -0,0 +1,193 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "archive.h"
+#include "job_system.h"
+#include "startup_profile.h"
+#include "texture_cache.h"
+
+class AssetManager;
+
+enum AssetType { ASSET_TEXTURE, ASSET_SURFACE, ASSET_FONT };
+
+// Reference-counted handle to an asset owned by an AssetManager. The asset is
+// freed when the last handle to it goes away.
+template <typename T>
+class AssetHandle {
+public:
+    AssetHandle() = default;
+    AssetHandle(AssetManager* manager, int id);
+    AssetHandle(const AssetHandle& other);
+    AssetHandle(AssetHandle&& other) noexcept;
+    AssetHandle& operator=(AssetHandle other) noexcept;
+    ~AssetHandle();
+
+    T* get() const;
+    explicit operator bool() const { return get() != nullptr; }
+    void reset();
+
+private:
+    AssetManager* manager = nullptr;
+    int id = -1;
+};
+
+using TextureHandle = AssetHandle<SDL_Texture>;
+using SurfaceHandle = AssetHandle<SDL_Surface>;
+using FontHandle = AssetHandle<TTF_Font>;
+
+struct AssetEntry {
+    std::string key;
+    std::string name;
+    std::string path;
+    AssetType type = ASSET_TEXTURE;
+    int fontSize = 0;
+    void* data = nullptr;
+    int refs = 0;
+    bool pending = false;
+    double loadMs = 0;
+    size_t bytes = 0;
+    unsigned lastUse = 0;
+    bool evicted = false;
+    // Asked for while evicted; pump() starts the reload.
+    bool reloadQueued = false;
+};
+
+struct TextureResidency {
+    size_t budget;
+    size_t resident;
+    size_t peak;
+    size_t evicted;
+    int evictions;
+};
+
+class AssetManager {
+public:
+    // An empty root resolves asset names against SDL_GetBasePath().
+    bool init(SDL_Renderer* renderer, const std::string& root);
+    void shutdown();
+
+    // Entries found in the archive are read from it instead of loose files.
+    void setArchive(AssetArchive* archive) { this->archive = archive; }
+    void setTextureCache(TextureCache* cache) { textureCache = cache; }
+    // Every asset that becomes resident is added to the profile's timeline.
+    void setStartupProfile(StartupProfile* profile) { startupProfile = profile; }
+    // Requests decode as jobs and finish through the main-thread queue.
+    // Without a job system they load synchronously.
+    void setJobSystem(JobSystem* jobs) { this->jobs = jobs; }
+
+    TextureHandle loadTexture(const std::string& name);
+    SurfaceHandle loadSurface(const std::string& name);
+    FontHandle loadFont(const std::string& name, int size);
+
+    // Decode on the job system; the handle stays empty until pump() has
+    // finished the asset on the main thread.
+    TextureHandle requestTexture(const std::string& name);
+    SurfaceHandle requestSurface(const std::string& name);
+    // Starts reloads of evicted textures that were asked for and finishes up
+    // to maxItems decoded assets. Call it outside guarded frames: both steps
+    // allocate.
+    void pump(int maxItems);
+    int pendingCount() const { return pending; }
+    int requestedCount() const { return requested; }
+
+    std::string resolve(const std::string& name) const;
+    // Opens an asset for incremental reading from the archive or disk; the
+    // caller closes it. Safe to call from any thread.
+    SDL_RWops* openStream(const std::string& name) { return openSource(name, resolve(name)); }
+    size_t residentBytes() const;
+    void report() const;
+
+    // Textures beyond the budget that were not used this frame are evicted
+    // least recently used first. A handle that asks for an evicted texture
+    // gets null until pump() has reloaded it in the background, so a frame
+    // never waits on a decode. A budget of 0 means unlimited.
+    void setTextureBudget(size_t bytes) { textureBudget = bytes; }
+    void endFrame();
+    TextureResidency textureResidency() const;
+
+    void retain(int id);
+    void release(int id);
+    void* data(int id);
+
+private:
+    struct Decoded {
+        int id;
+        SDL_Surface* surface;
+        CachedTexture cached;
+        bool converted;
+        double decodeMs;
+    };
+
+    int find(AssetType type, const std::string& name, int fontSize);
+    int acquire(AssetType type, const std::string& name, int fontSize);
+    int acquireAsync(AssetType type, const std::string& name);
+    void startDecode(int id);
+    bool load(AssetEntry& entry);
+    Decoded decode(int id, AssetType type, const std::string& name, const std::string& path);
+    void finish(const Decoded& result);
+    bool complete(AssetEntry& entry, const Decoded& result);
+    void unload(AssetEntry& entry);
+    void trimTextures();
+    SDL_RWops* openSource(const std::string& name, const std::string& path);
+
+    SDL_Renderer* renderer = nullptr;
+    AssetArchive* archive = nullptr;
+    TextureCache* textureCache = nullptr;
+    StartupProfile* startupProfile = nullptr;
+    std::string root;
+    std::vector<AssetEntry> entries;
+
+    JobSystem* jobs = nullptr;
+    JobCounter decoding;
+    int pending = 0;
+    int requested = 0;
+    int queuedReloads = 0;
+
+    unsigned frame = 0;
+    size_t textureBudget = 0;
+    size_t textureBytes = 0;
+    size_t peakTextureBytes = 0;
+    size_t evictedTextureBytes = 0;
+    int evictions = 0;
+};
+
+template <typename T>
+AssetHandle<T>::AssetHandle(AssetManager* manager, int id) : manager(manager), id(id) {}
+
+template <typename T>
+AssetHandle<T>::AssetHandle(const AssetHandle& other) : manager(other.manager), id(other.id) {
+    if (manager) manager->retain(id);
+}
+
+template <typename T>
+AssetHandle<T>::AssetHandle(AssetHandle&& other) noexcept : manager(other.manager), id(other.id) {
+    other.manager = nullptr;
+    other.id = -1;
+}
+
+template <typename T>
+AssetHandle<T>& AssetHandle<T>::operator=(AssetHandle other) noexcept {
+    std::swap(manager, other.manager);
+    std::swap(id, other.id);
+    return *this;
+}
+
+template <typename T>
+AssetHandle<T>::~AssetHandle() {
+    reset();
+}
+
+template <typename T>
+T* AssetHandle<T>::get() const {
+    return manager ? static_cast<T*>(manager->data(id)) : nullptr;
+}
+
+template <typename T>
+void AssetHandle<T>::reset() {
+    if (manager) manager->release(id);
+    manager = nullptr;
+    id = -1;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <SDL2/SDL.h>
+
+// Printable ASCII is all the game draws, so that is all that gets baked.
+const int BAKED_FIRST_CHAR = ' ';
+const int BAKED_LAST_CHAR = '~';
+const int BAKED_GLYPH_COUNT = BAKED_LAST_CHAR - BAKED_FIRST_CHAR + 1;
+const int BAKED_ATLAS_WIDTH = 256;
+
+// Glyph rectangle in the atlas, and where it goes relative to the pen
+// position and the top of the line.
+struct BakedGlyph {
+    Sint16 x, y, w, h;
+    Sint16 offsetX, offsetY;
+    Sint16 advance;
+};
+
+struct BakedKerning {
+    Uint8 first, second;
+    Sint8 amount;
+};
+
+// One font at one point size, as written by tools/bake_fonts.cpp. atlas holds
+// 8-bit coverage; kerning is sorted by (first, second).
+struct BakedFont {
+    const char* name;
+    int size;
+    int height;
+    int atlasHeight;
+    const Uint8* atlas;
+    const BakedGlyph* glyphs;
+    const BakedKerning* kerning;
+    int kerningCount;
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <array>
+#include <vector>
+#include "game.h"
+#include "job_system.h"
+
+const int DISC_RADIUS = OBJECT_SIZE / 4;
+const int RASTER_TILE_HEIGHT = 64;
+const int MAX_DIRTY_RECTS = 128;
+
+constexpr int constexprSqrt(int value) {
+    int root = 0;
+    while ((root + 1) * (root + 1) <= value) {
+        ++root;
+    }
+    return root;
+}
+
+// Half-width of every row of a filled disc, indexed by dy + radius.
+template <int Radius>
+constexpr std::array<int, 2 * Radius + 1> makeDiscSpans() {
+    std::array<int, 2 * Radius + 1> spans{};
+    for (int dy = -Radius; dy <= Radius; ++dy) {
+        spans[dy + Radius] = constexprSqrt(Radius * Radius - dy * dy);
+    }
+    return spans;
+}
+
+constexpr auto DISC_SPANS = makeDiscSpans<DISC_RADIUS>();
+
+// ARGB8888 pixels with premultiplied alpha. version changes whenever the pixels do.
+struct Sprite {
+    int w = 0, h = 0;
+    unsigned version = 0;
+    std::vector<Uint32> pixels;
+};
+
+bool makeSprite(SDL_Surface* surface, int w, int h, Sprite& sprite);
+
+class CpuRasterizer {
+public:
+    // Tiles are rasterized in parallel on jobs; null rasterizes them serially.
+    bool init(SDL_Renderer* renderer, SDL_Surface* background, JobSystem* jobs, bool dirtyRects);
+    void shutdown();
+
+    void beginFrame();
+    void addDisc(int centerX, int centerY, Uint32 color);
+    void addSprite(const Sprite* sprite, int x, int y);
+    void endFrame();
+
+    int lastFilledPixels() const { return filledPixels; }
+
+private:
+    struct Command {
+        const Sprite* sprite;
+        int x, y;
+        int w, h;
+        Uint32 color;
+        unsigned version;
+    };
+
+    static SDL_Rect bounds(const Command& command);
+    bool collectDirtyRects();
+    void rasterizeRect(const SDL_Rect& clip);
+    void runWork();
+
+    SDL_Renderer* renderer = nullptr;
+    JobSystem* jobs = nullptr;
+    SDL_Texture* texture = nullptr;
+    std::vector<Uint32> background;
+    std::vector<Command> commands;
+    std::vector<Command> previousCommands;
+    std::vector<SDL_Rect> tiles;
+    std::vector<SDL_Rect> dirty;
+    const std::vector<SDL_Rect>* work = nullptr;
+    Uint32* framePixels = nullptr;
+    int framePitch = 0;
+    int filledPixels = 0;
+
+    bool dirtyRects = false;
+    bool fullRedraw = true;
+    std::vector<Uint32> frame;
+};
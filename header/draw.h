@@ -0,0 +1,4 @@
+#pragma once
+#include <SDL2/SDL.h>
+
+void drawCircle(SDL_Renderer* renderer, int centerX, int centerY, int radius);
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <new>
+
+const int ALLOC_GUARD_WARMUP_FRAMES = 120;
+
+// Linear allocator for memory that lives for one frame. reset() at the start
+// of the frame releases everything at once; nothing is freed individually.
+// Allocations past the capacity fail and are counted, they never fall back
+// to the heap.
+class FrameArena {
+public:
+    FrameArena() = default;
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    ~FrameArena();
+
+    bool init(size_t capacity);
+    void reset() { offset = 0; }
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    template <typename T>
+    T* allocate(size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+    // label followed by value, formatted with std::to_chars. Never null.
+    const char* format(const char* label, int value);
+
+    size_t used() const { return offset; }
+    size_t peak() const { return high; }
+    int overflows() const { return overflowCount; }
+
+private:
+    unsigned char* memory = nullptr;
+    size_t capacity = 0;
+    size_t offset = 0;
+    size_t high = 0;
+    int overflowCount = 0;
+};
+
+// Debug check that steady-state frames never reach the global heap. When
+// enabled, every frame a thread brackets with begin()/end() after its first
+// ALLOC_GUARD_WARMUP_FRAMES aborts on operator new. Only C++ allocations are
+// seen; SDL's own allocator is not.
+void enableAllocationGuard();
+
+class AllocationGuard {
+public:
+    void begin();
+    void end();
+
+private:
+    int frames = 0;
+};
@@ -0,0 +1,127 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cmath>
+
+const int SCREEN_WIDTH = 800;
+const int SCREEN_HEIGHT = 600;
+const int OBJECT_SIZE = 120;
+const int TRAIL_LENGTH = 10;
+const int SPAWN_INTERVAL = 40;
+// Capacity of the object pool; spawns beyond it are skipped.
+const int MAX_OBJECTS = 131072;
+
+enum ObjectType { FRUIT, BOMB, FRAGMENT };
+
+// xorshift32. Each thread that needs random numbers owns one, so nothing
+// depends on the C runtime's rand() state, which is per thread on MSVCRT.
+struct Random {
+    Uint32 state = 0x9E3779B9u;
+
+    void seed(Uint32 value) { state = value ? value : 0x9E3779B9u; }
+    Uint32 next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    // Uniform enough for gameplay in [0, n).
+    int below(int n) { return static_cast<int>(next() % static_cast<Uint32>(n)); }
+};
+
+struct GameObject {
+    int x, y;
+    float speed;
+    int peakHeight;
+    bool rising;
+    ObjectType type;
+    bool sliced;
+    int fragmentDirection;
+
+    // floor is the bottom of the playfield; the throw height is measured from it.
+    GameObject(int startX, int startY, ObjectType objType, Random& random, int direction = 0, int floor = SCREEN_HEIGHT) {
+        x = startX;
+        y = startY;
+        speed = (random.below(4) + 2) * 1.5;
+        peakHeight = floor - (speed * 40);
+        rising = true;
+        type = objType;
+        sliced = false;
+        fragmentDirection = direction;
+    }
+
+    void update() {
+        if (type == FRAGMENT) {
+            y += speed;
+            x += fragmentDirection * 3;
+        } else {
+            if (rising) {
+                y -= speed;
+                if (y <= peakHeight) {
+                    rising = false;
+                }
+            } else {
+                y += speed;
+            }
+        }
+    }
+
+    // Fragments leave once they drop off screen; fruit and bombs wait until the
+    // blade can no longer reach them from inside the window.
+    bool isGone(int floor = SCREEN_HEIGHT) const {
+        if (type == FRAGMENT) return y > floor;
+        return !rising && y > floor + OBJECT_SIZE;
+    }
+
+    bool isSliced(int prevX, int prevY, int mouseX, int mouseY) const {
+        int radius = OBJECT_SIZE / 4;
+        float centerX = x + radius;
+        float centerY = y + radius;
+
+        float dx = mouseX - prevX;
+        float dy = mouseY - prevY;
+        float len = sqrt(dx * dx + dy * dy);
+        if (len < 1) return false;
+
+        float A = dy;
+        float B = -dx;
+        float C = dx * prevY - dy * prevX;
+        float distance = fabs(A * centerX + B * centerY + C) / len;
+        bool intersects = distance <= radius;
+
+        float endDx = mouseX - centerX;
+        float endDy = mouseY - centerY;
+        float endDistance = sqrt(endDx * endDx + endDy * endDy);
+        bool closeEnough = endDistance < OBJECT_SIZE;
+
+        float movementX = mouseX - prevX;
+        float movementY = mouseY - prevY;
+        bool hasMovement = (movementX * movementX + movementY * movementY) > 25;
+
+        return intersects && closeEnough && hasMovement;
+    }
+};
+
+// The last TRAIL_LENGTH blade positions, oldest first.
+struct Trail {
+    std::array<SDL_Point, TRAIL_LENGTH> points;
+    int count = 0;
+
+    void addPoint(int x, int y) {
+        if (count == TRAIL_LENGTH) {
+            fade();
+        }
+        points[count++] = {x, y};
+    }
+
+    void fade() {
+        if (count > 0) {
+            std::copy(points.begin() + 1, points.begin() + count, points.begin());
+            --count;
+        }
+    }
+
+    void clear() { count = 0; }
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+
+enum GameEventType { EVENT_SLICE, EVENT_BOMB_HIT, EVENT_FRUIT_MISSED, EVENT_GAME_OVER, EVENT_TYPE_COUNT };
+
+// x and y are the object's top-left corner, as in GameObject.
+struct GameEvent {
+    GameEventType type;
+    int x, y;
+};
+
+// What happened during one simulation step. The hot object loop only appends
+// here; scoring, effects, audio and stats read the whole batch afterwards.
+// Storage is reserved once, so pushing never allocates.
+class GameEventBuffer {
+public:
+    void reserve(int capacity) { events.reserve(capacity); }
+
+    void clear() {
+        events.clear();
+        for (int& count : counts) {
+            count = 0;
+        }
+    }
+
+    void push(GameEventType type, int x, int y) {
+        if (events.size() == events.capacity()) return;
+        events.push_back({type, x, y});
+        ++counts[type];
+    }
+
+    int count(GameEventType type) const { return counts[type]; }
+    const std::vector<GameEvent>& all() const { return events; }
+
+private:
+    std::vector<GameEvent> events;
+    int counts[EVENT_TYPE_COUNT] = {};
+};
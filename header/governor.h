@@ -0,0 +1,89 @@
+#pragma once
+#include <SDL2/SDL.h>
+
+// Weight of the newest frame in the smoothed frame time.
+const double GOVERNOR_SMOOTHING = 0.1;
+// Quality drops after the smoothed frame time has been over budget for
+// GOVERNOR_DOWN_FRAMES frames in a row, and rises after it has been under
+// GOVERNOR_HEADROOM of the budget for the current rise delay. No change
+// follows another within GOVERNOR_COOLDOWN_FRAMES.
+const int GOVERNOR_DOWN_FRAMES = 30;
+const int GOVERNOR_UP_FRAMES = 180;
+const double GOVERNOR_HEADROOM = 0.6;
+const int GOVERNOR_COOLDOWN_FRAMES = 60;
+// A drop this soon after a rise means the rise did not fit the budget; the
+// rise delay doubles each time, up to GOVERNOR_MAX_UP_FRAMES.
+const int GOVERNOR_RETRY_FRAMES = 600;
+const int GOVERNOR_MAX_UP_FRAMES = 8 * GOVERNOR_UP_FRAMES;
+
+struct QualityLevel {
+    // Fraction of the window resolution the scene is drawn at.
+    float renderScale;
+    // Fraction of the particles slices and bomb hits emit.
+    float effectDensity;
+    // Catmull-Rom samples per trail segment.
+    int trailSubdivisions;
+};
+
+// Level 0 is full quality. Effects go first; resolution only drops once they
+// are already thinned.
+const QualityLevel QUALITY_LEVELS[] = {
+    {1.0f, 1.0f, 4},
+    {1.0f, 0.5f, 2},
+    {0.75f, 0.5f, 2},
+    {0.5f, 0.25f, 1},
+};
+const int QUALITY_LEVEL_COUNT = sizeof(QUALITY_LEVELS) / sizeof(QUALITY_LEVELS[0]);
+
+enum GovernorDecision { GOVERNOR_HOLD, GOVERNOR_LOWER, GOVERNOR_RAISE };
+
+// Trades visual fidelity for frame time. Fed the work time of each frame
+// (everything up to SDL_RenderPresent, not the sleep after it), it steps
+// through QUALITY_LEVELS to keep the smoothed time under the budget.
+class FrameGovernor {
+public:
+    // A budget of 0 only measures and stays at full quality.
+    void init(double budgetMs);
+    GovernorDecision record(double frameMs);
+
+    const QualityLevel& quality() const { return QUALITY_LEVELS[current]; }
+    int level() const { return current; }
+    double budget() const { return budgetMs; }
+    double averageMs() const { return average; }
+    // The last change, for the profiler overlay.
+    GovernorDecision lastDecision() const { return lastChange; }
+    unsigned lastDecisionFrame() const { return lastChangeFrame; }
+    double lastDecisionMs() const { return lastChangeMs; }
+
+private:
+    void change(int level, GovernorDecision decision);
+
+    double budgetMs = 0;
+    double average = 0;
+    int current = 0;
+    unsigned frames = 0;
+    int overFrames = 0, underFrames = 0;
+    int upFrames = GOVERNOR_UP_FRAMES;
+    GovernorDecision lastChange = GOVERNOR_HOLD;
+    unsigned lastChangeFrame = 0;
+    double lastChangeMs = 0;
+};
+
+// Draws the scene into a target texture at a fraction of the window size and
+// stretches it over the window. Falls back to drawing straight to the window
+// when the renderer has no target textures.
+class ScaledTarget {
+public:
+    bool init(SDL_Renderer* renderer, int width, int height);
+    void shutdown();
+    // Everything drawn between begin() and end() is in window coordinates.
+    void begin(float scale);
+    void end();
+
+private:
+    SDL_Renderer* renderer = nullptr;
+    SDL_Texture* texture = nullptr;
+    int width = 0, height = 0;
+    SDL_Rect area = {0, 0, 0, 0};
+    bool active = false;
+};
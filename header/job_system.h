@@ -0,0 +1,134 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Jobs a single deque holds; a full deque runs new jobs inline instead.
+const int JOB_QUEUE_CAPACITY = 1024;
+
+// Counts jobs that have been submitted against it and not finished yet. Jobs
+// submitted with submitAfter() start once it drops to zero. Only reuse a
+// counter after waiting on it.
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool done();
+
+private:
+    friend class JobSystem;
+
+    std::atomic<int> count{0};
+    std::mutex mutex;
+    std::vector<std::pair<std::function<void()>, JobCounter*>> continuations;
+};
+
+// Worker threads with one deque each. A worker pushes and pops its own jobs at
+// the back and steals from the front of the others' when it runs dry. Threads
+// that are not workers (the main thread) submit to a shared deque, and help
+// run jobs while they wait. Jobs must not touch the renderer; they hand that
+// work back through runOnMainThread().
+class JobSystem {
+public:
+    JobSystem() = default;
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    ~JobSystem() { stop(); }
+
+    // threadCount counts the calling thread, which helps in wait(); <= 0 means
+    // one per core.
+    void start(int threadCount);
+    void stop();
+    // Threads that run jobs during wait(): the workers plus the caller.
+    int concurrency() const { return static_cast<int>(threads.size()) + 1; }
+
+    void submit(std::function<void()> job, JobCounter* counter = nullptr);
+    void submitAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter = nullptr);
+    void wait(JobCounter& counter);
+
+    // Calls body(first, last) over [begin, end) in chunks of at most grain
+    // indices and returns when all of them are done. Never allocates.
+    template <typename Body>
+    void parallelFor(int begin, int end, int grain, Body&& body);
+
+    void runOnMainThread(std::function<void()> job);
+    int pumpMainThread(int maxJobs = INT_MAX);
+
+private:
+    typedef void (*RangeFunction)(void* data, int first, int last);
+
+    // Either a std::function or a range over a caller-owned body; the latter
+    // is what parallelFor uses so it never allocates.
+    struct Job {
+        std::function<void()> function;
+        RangeFunction range = nullptr;
+        void* data = nullptr;
+        int first = 0, last = 0;
+        JobCounter* counter = nullptr;
+
+        void run() {
+            if (range) range(data, first, last);
+            else function();
+        }
+    };
+    // Fixed ring of jobs; the owner works at the back, thieves take the front.
+    struct Queue {
+        std::mutex mutex;
+        std::vector<Job> jobs;
+        size_t head = 0, tail = 0;
+    };
+
+    template <typename Body>
+    static void callRange(void* body, int first, int last) {
+        (*static_cast<Body*>(body))(first, last);
+    }
+
+    void submitRange(RangeFunction range, void* data, int first, int last, JobCounter* counter);
+    void push(Job&& job);
+    bool runOne(int index);
+    void finish(JobCounter* counter);
+    void workerLoop(int index);
+    int currentIndex() const;
+
+    // queues[0] is shared by every thread that is not a worker.
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<int> queued{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    std::mutex mainMutex;
+    std::deque<std::function<void()>> mainJobs;
+};
+
+template <typename Body>
+void JobSystem::parallelFor(int begin, int end, int grain, Body&& body) {
+    if (end <= begin) return;
+    grain = std::max(1, grain);
+    if (end - begin <= grain || threads.empty()) {
+        body(begin, end);
+        return;
+    }
+    typedef std::remove_reference_t<Body> Function;
+    void* data = const_cast<void*>(static_cast<const void*>(std::addressof(body)));
+    JobCounter counter;
+    for (int first = begin + grain; first < end; first += grain) {
+        submitRange(&callRange<Function>, data, first, std::min(end, first + grain), &counter);
+    }
+    body(begin, begin + grain);
+    wait(counter);
+}
+
+// Times a compute-bound parallelFor and a particle update on 1 to N threads.
+void runJobBenchmark(int frames);
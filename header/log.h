@@ -0,0 +1,159 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Levels as plain macros so builds can strip them in the preprocessor, e.g.
+// -DLOG_COMPILED_LEVEL=LOG_LEVEL_INFO removes every trace and debug call
+// together with its arguments.
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARN 3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_OFF 5
+
+#ifndef LOG_COMPILED_LEVEL
+#define LOG_COMPILED_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+enum LogSubsystem { LOG_CORE, LOG_RENDER, LOG_ASSETS, LOG_AUDIO, LOG_SIM, LOG_SUBSYSTEM_COUNT };
+
+const int LOG_RING_CAPACITY = 4096;
+const int LOG_MAX_ARGUMENTS = 6;
+const int LOG_TEXT_BYTES = 168;
+
+enum LogArgumentType : Uint8 { LOG_ARG_INT, LOG_ARG_UINT, LOG_ARG_DOUBLE, LOG_ARG_STRING };
+
+// One fixed-size binary log entry. format must be a string literal; it is
+// only read by the writer thread. String arguments are copied into text.
+struct LogRecord {
+    Uint64 time;
+    const char* format;
+    Uint8 level;
+    Uint8 subsystem;
+    Uint8 argumentCount;
+    Uint8 textUsed;
+    LogArgumentType types[LOG_MAX_ARGUMENTS];
+    union {
+        long long i;
+        unsigned long long u;
+        double d;
+    } values[LOG_MAX_ARGUMENTS];
+    char text[LOG_TEXT_BYTES];
+};
+
+extern std::atomic<Uint8> logLevels[LOG_SUBSYSTEM_COUNT];
+
+// Record timestamps read the time stamp counter where there is one; the
+// writer converts them to seconds against the performance counter.
+inline Uint64 logTimestamp() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return SDL_GetPerformanceCounter();
+#endif
+}
+
+// Starts the writer thread. An empty path writes to stderr. Records logged
+// before this are kept and written once it runs; logStop() also runs at exit.
+bool logStart(const std::string& path);
+void logStop();
+bool logSetLevel(const char* setting);
+// Waits until the writer has caught up with everything logged so far.
+void logFlush();
+void runLogBenchmark();
+
+// Claims a ring slot; null when the ring is full and the record is dropped.
+LogRecord* logBegin();
+void logCommit(LogRecord* record);
+
+inline bool logEnabled(LogSubsystem subsystem, int level) {
+    return level >= logLevels[subsystem].load(std::memory_order_relaxed);
+}
+
+template <typename T>
+inline void logEncode(LogRecord& record, int index, const T& value) {
+    typedef std::decay_t<T> Type;
+    if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*> || std::is_same_v<Type, std::string>) {
+        const char* text;
+        if constexpr (std::is_same_v<Type, std::string>) text = value.c_str();
+        else if constexpr (std::is_array_v<T>) text = value;
+        else text = value ? value : "(null)";
+        record.types[index] = LOG_ARG_STRING;
+        int room = LOG_TEXT_BYTES - 1 - record.textUsed;
+        if (room <= 0) {
+            // The text area is full: no string can have text in its last
+            // byte, so an empty string there is safe to point at.
+            record.text[LOG_TEXT_BYTES - 1] = '\0';
+            record.values[index].u = LOG_TEXT_BYTES - 1;
+            return;
+        }
+        size_t length = std::min(std::strlen(text), static_cast<size_t>(room));
+        std::memcpy(record.text + record.textUsed, text, length);
+        record.text[record.textUsed + length] = '\0';
+        record.values[index].u = record.textUsed;
+        record.textUsed = static_cast<Uint8>(record.textUsed + length + 1);
+    } else if constexpr (std::is_floating_point_v<Type>) {
+        record.types[index] = LOG_ARG_DOUBLE;
+        record.values[index].d = value;
+    } else if constexpr (std::is_unsigned_v<Type>) {
+        record.types[index] = LOG_ARG_UINT;
+        record.values[index].u = value;
+    } else {
+        static_assert(std::is_integral_v<Type> || std::is_enum_v<Type>, "unsupported log argument");
+        record.types[index] = LOG_ARG_INT;
+        record.values[index].i = static_cast<long long>(value);
+    }
+}
+
+// Each {} in format is replaced by the next argument when the record is written.
+template <typename... Args>
+void logMessage(LogSubsystem subsystem, int level, const char* format, const Args&... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGUMENTS, "too many log arguments");
+    if (!logEnabled(subsystem, level)) return;
+    LogRecord* record = logBegin();
+    if (!record) return;
+    record->time = logTimestamp();
+    record->format = format;
+    record->level = static_cast<Uint8>(level);
+    record->subsystem = static_cast<Uint8>(subsystem);
+    record->argumentCount = static_cast<Uint8>(sizeof...(Args));
+    record->textUsed = 0;
+    int index = 0;
+    (logEncode(*record, index++, args), ...);
+    (void)index;
+    logCommit(record);
+}
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(subsystem, ...) logMessage(subsystem, LOG_LEVEL_TRACE, __VA_ARGS__)
+#else
+#define LOG_TRACE(subsystem, ...) ((void)0)
+#endif
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(subsystem, ...) logMessage(subsystem, LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(subsystem, ...) ((void)0)
+#endif
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(subsystem, ...) logMessage(subsystem, LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(subsystem, ...) ((void)0)
+#endif
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(subsystem, ...) logMessage(subsystem, LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(subsystem, ...) ((void)0)
+#endif
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(subsystem, ...) logMessage(subsystem, LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(subsystem, ...) ((void)0)
+#endif
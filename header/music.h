@@ -0,0 +1,79 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <array>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "assets.h"
+#include "sample_ring.h"
+#include "spsc_queue.h"
+
+struct OggVorbis_File;
+
+// Optional: the game runs silent, with one warning per track, without them.
+const char* const MENU_TRACK = "asset/menu.ogg";
+const char* const GAME_TRACK = "asset/game.ogg";
+const int MUSIC_FADE_MS = 1500;
+const size_t MUSIC_RING_FRAMES = 32768;
+const int MUSIC_DECODE_FRAMES = 1024;
+const float MUSIC_VOLUME = 0.5f;
+
+struct MusicCommand {
+    char track[64];
+    int fadeMs;
+};
+
+// Streams looping Ogg Vorbis tracks. A decoder thread reads each file in small
+// blocks through the AssetManager (so tracks can live in the archive) and
+// fills a fixed ring of stereo float PCM per deck; the SDL_mixer music hook
+// drains the rings on the audio thread and crossfades between the two decks.
+// Memory is the same for a ten-second loop and a ten-minute track.
+class MusicPlayer {
+public:
+    bool init(AssetManager& assets);
+    void shutdown();
+
+    // Crossfades to track, or fades out when track is empty. Never blocks.
+    void play(const std::string& track, int fadeMs = MUSIC_FADE_MS);
+    int underruns() const { return underrunCount.load(); }
+
+private:
+    struct Deck {
+        SampleRing ring;
+        OggVorbis_File* file = nullptr;
+        std::string track;
+        int channels = 0;
+        double step = 1.0;
+        double position = 0;
+        float previous[2] = {0, 0};
+        std::vector<float> resampled;
+
+        // Owned by the audio callback.
+        float fade = 0;
+        std::atomic<bool> audible{false};
+    };
+
+    static void hook(void* userdata, Uint8* stream, int length);
+    void mix(Sint16* out, int frames);
+    void run();
+    bool openDeck(Deck& deck, const std::string& track);
+    void closeDeck(Deck& deck);
+    bool fill(Deck& deck);
+
+    AssetManager* assets = nullptr;
+    int frequency = 0;
+    int outputChannels = 0;
+    std::array<Deck, 2> decks;
+    // Tracks that failed to open; the decoder does not try them again.
+    std::vector<std::string> unplayable;
+
+    SpscQueue<MusicCommand, 16> commands;
+    std::atomic<int> target{-1};
+    std::atomic<int> fadeFrames{1};
+    std::atomic<int> underrunCount{0};
+
+    SDL_sem* wake = nullptr;
+    std::thread thread;
+    std::atomic<bool> running{false};
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include "frame_memory.h"
+#include "game.h"
+#include "game_events.h"
+#include "job_system.h"
+
+// Objects per chunk; each chunk is updated by one job.
+const int OBJECT_CHUNK = 1024;
+
+struct Blade {
+    bool active;
+    int prevX, prevY;
+    int x, y;
+};
+
+// Moves every object one frame and tests it against the blade. Fruit and bombs
+// the blade hit are removed and reported as EVENT_SLICE or EVENT_BOMB_HIT;
+// fruit that fell off screen unsliced as EVENT_FRUIT_MISSED. Chunks are
+// processed in parallel into their own survivor and event buffers, then
+// merged in chunk order on the calling thread, so objects and events come out
+// exactly as a serial pass would produce them. The chunk buffers come from the
+// caller's frame arena; if it is short of scratchBytes(), update() logs it once
+// and falls back to a serial pass in place.
+class ObjectUpdater {
+public:
+    // Sizes the merge buffer for up to capacity objects.
+    void reserve(int capacity) { merged.reserve(capacity); }
+    // Bottom of the playfield objects fall out of; SCREEN_HEIGHT by default.
+    void setFloor(int y) { floor = y; }
+    // Arena bytes update() needs for count objects.
+    static size_t scratchBytes(int count);
+
+    void update(std::vector<GameObject>& objects, const Blade& blade, JobSystem* jobs, FrameArena& arena,
+                GameEventBuffer& events);
+
+private:
+    struct alignas(64) Chunk {
+        GameObject* survivors;
+        GameEvent* events;
+        int survivorCount;
+        int eventCount;
+    };
+
+    void updateChunk(const std::vector<GameObject>& objects, const Blade& blade, Chunk& chunk, int index);
+    void updateInPlace(std::vector<GameObject>& objects, const Blade& blade, GameEventBuffer& events);
+
+    std::vector<GameObject> merged;
+    int floor = SCREEN_HEIGHT;
+    bool scratchWarned = false;
+};
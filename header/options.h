@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "stress.h"
+
+struct Options {
+    std::string renderer;
+    bool listRenderers = false;
+    bool rendererBench = false;
+    int benchFrames = 300;
+    bool cpuRender = false;
+    int jobThreads = 0;
+    bool dirtyRects = false;
+    bool smoothTrail = true;
+    bool frameStats = false;
+    double frameBudgetMs = 12;
+    bool profiler = false;
+    bool allocGuard = false;
+    bool particleBench = false;
+    bool jobBench = false;
+    std::string assetRoot;
+    bool assetReport = false;
+    bool textureCache = true;
+    int textureBudgetMb = 16;
+    bool bakedFonts = true;
+    bool startupBench = false;
+    bool audio = true;
+    int audioBuffer = 512;
+    std::string audioDriver;
+    bool audioStress = false;
+    std::string logFile;
+    std::vector<std::string> logLevels;
+    bool logBench = false;
+    bool stressScene = false;
+    StressConfig stress;
+};
+
+bool parseOptions(int argc, char* argv[], Options& options);
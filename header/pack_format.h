@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+
+// On-disk layout of assets.pak: PackHeader, then entryCount PackEntry records,
+// then the entry data. Offsets are from the start of the file and every entry
+// starts on a PACK_ALIGNMENT boundary.
+const char PACK_MAGIC[4] = {'F', 'P', 'A', 'K'};
+const uint32_t PACK_VERSION = 1;
+const uint32_t PACK_ALIGNMENT = 16;
+const uint32_t PACK_NAME_LENGTH = 64;
+const uint32_t PACK_FLAG_ZSTD = 1;
+
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct PackEntry {
+    char name[PACK_NAME_LENGTH];
+    uint64_t offset;
+    uint64_t storedSize;
+    uint64_t rawSize;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(PackHeader) == 16, "PackHeader layout");
+static_assert(sizeof(PackEntry) == 96, "PackEntry layout");
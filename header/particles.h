@@ -0,0 +1,74 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <vector>
+
+class JobSystem;
+
+const int MAX_PARTICLES = 65536;
+const int PARTICLE_JOB_GRAIN = 8192;
+const float PARTICLE_GRAVITY = 0.25f;
+
+struct ParticleEmitter {
+    float speedMin, speedMax;
+    int lifeMin, lifeMax;
+    float size;
+    SDL_Color color;
+};
+
+const ParticleEmitter JUICE_EMITTER = {2.0f, 6.0f, 20, 40, 4.0f, {220, 20, 30, 255}};
+const ParticleEmitter BLAST_EMITTER = {3.0f, 10.0f, 30, 60, 5.0f, {255, 170, 40, 255}};
+
+// Live particles as the renderer needs them, with life already folded into alpha.
+struct ParticleFrame {
+    std::vector<float> x, y, size;
+    std::vector<SDL_Color> color;
+    int count = 0;
+
+    void reserve() {
+        x.reserve(MAX_PARTICLES);
+        y.reserve(MAX_PARTICLES);
+        size.reserve(MAX_PARTICLES);
+        color.reserve(MAX_PARTICLES);
+    }
+};
+
+// Fixed-capacity particle pool stored as structure-of-arrays. Dead particles
+// are swapped with the last live one, so the live range is always [0, count).
+class ParticleSystem {
+public:
+    ParticleSystem();
+
+    // Returns how many were emitted; the rest did not fit the pool.
+    int emit(const ParticleEmitter& emitter, float x, float y, int count);
+    // Integrates in parallel on jobs when given one; compaction stays serial.
+    void update(JobSystem* jobs = nullptr);
+    void snapshot(ParticleFrame& frame) const;
+    void clear() { live = 0; }
+    int count() const { return live; }
+
+private:
+    float random01();
+    void integrate(int first, int last);
+
+    std::vector<float> x, y, vx, vy;
+    std::vector<float> life, fade;
+    std::vector<float> size;
+    std::vector<SDL_Color> color;
+    int live = 0;
+    Uint32 seed = 0x9E3779B9u;
+};
+
+// Draws a particle frame as quads in one SDL_RenderGeometryRaw call.
+class ParticleRenderer {
+public:
+    ParticleRenderer();
+
+    void render(SDL_Renderer* renderer, const ParticleFrame& frame);
+
+private:
+    std::vector<float> xy;
+    std::vector<SDL_Color> vertexColors;
+    std::vector<int> indices;
+};
+
+void runParticleBenchmark(int frames);
@@ -0,0 +1,8 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+
+void listRenderDrivers();
+int findRenderDriver(const std::string& name);
+SDL_Renderer* createRenderer(SDL_Window* window, const std::string& name);
+void runRendererBenchmark(SDL_Surface* background, SDL_Surface* bomb, int frames);
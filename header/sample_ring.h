@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Lock-free single-producer/single-consumer ring of float samples. The
+// storage is allocated once by init(); write() and read() copy as much as
+// fits and never block. capacity must be a power of two.
+class SampleRing {
+public:
+    void init(size_t capacity) {
+        samples.assign(capacity, 0.0f);
+        mask = capacity - 1;
+        reset();
+    }
+
+    // Only safe while neither side is using the ring.
+    void reset() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_release);
+    }
+
+    size_t available() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    size_t space() const { return samples.size() - available(); }
+
+    size_t write(const float* data, size_t count) {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        count = std::min(count, samples.size() - (tail - head.load(std::memory_order_acquire)));
+        for (size_t i = 0; i < count; ++i) {
+            samples[(tail + i) & mask] = data[i];
+        }
+        this->tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t read(float* data, size_t count) {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        count = std::min(count, this->tail.load(std::memory_order_acquire) - head);
+        for (size_t i = 0; i < count; ++i) {
+            data[i] = samples[(head + i) & mask];
+        }
+        this->head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::vector<float> samples;
+    size_t mask = 0;
+};
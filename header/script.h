@@ -0,0 +1,91 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <vector>
+#include "timer_wheel.h"
+
+const int MAX_SCRIPTS = 64;
+const size_t SCRIPT_FRAME_BYTES = 512;
+
+class ScriptScheduler;
+
+// A coroutine run by a ScriptScheduler, which waits between steps with
+// co_await ticks(n). It does nothing until handed to ScriptScheduler::start().
+// Coroutine frames come from a fixed pool of MAX_SCRIPTS blocks, so starting a
+// script mid-game does not touch the heap; scripts belong to the simulation
+// thread.
+class Script {
+public:
+    struct promise_type {
+        ScriptScheduler* scheduler = nullptr;
+
+        Script get_return_object() { return Script(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+
+        static void* operator new(size_t size);
+        static void operator delete(void* frame, size_t size);
+    };
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    Script(Script&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    Script(const Script&) = delete;
+    Script& operator=(const Script&) = delete;
+    ~Script() {
+        if (handle) handle.destroy();
+    }
+
+private:
+    friend class ScriptScheduler;
+
+    explicit Script(Handle handle) : handle(handle) {}
+
+    Handle handle;
+};
+
+struct TickAwaiter {
+    Uint32 count;
+
+    bool await_ready() const { return count == 0; }
+    void await_suspend(Script::Handle handle);
+    void await_resume() const {}
+};
+
+// Suspends the calling script for count simulation ticks.
+inline TickAwaiter ticks(Uint32 count) {
+    return {count};
+}
+
+// Runs scripts on a timer wheel advanced by tick(). A suspended script costs
+// nothing until its timer fires. The wheel also takes plain callbacks.
+class ScriptScheduler {
+public:
+    ScriptScheduler() = default;
+    ScriptScheduler(const ScriptScheduler&) = delete;
+    ScriptScheduler& operator=(const ScriptScheduler&) = delete;
+    ~ScriptScheduler() { clear(); }
+
+    // timerCapacity is for plain callbacks on top of one timer per script.
+    void init(int timerCapacity);
+    // Runs script up to its first co_await. Returns false when MAX_SCRIPTS
+    // are already running.
+    bool start(Script script);
+    void tick();
+    // Destroys every script and pending timer.
+    void clear();
+
+    int running() const { return static_cast<int>(scripts.size()); }
+    TimerWheel& timers() { return wheel; }
+
+private:
+    friend struct TickAwaiter;
+
+    static void resume(void* address);
+    void run(Script::Handle handle);
+
+    TimerWheel wheel;
+    std::vector<Script::Handle> scripts;
+};
@@ -0,0 +1,143 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "frame_memory.h"
+#include "game.h"
+#include "game_events.h"
+#include "job_system.h"
+#include "music.h"
+#include "object_update.h"
+#include "particles.h"
+#include "script.h"
+#include "sound.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+
+const int SIMULATION_STEP_MS = 16;
+const int INPUT_QUEUE_CAPACITY = 256;
+const int START_HP = 5;
+// Every DIFFICULTY_STEP_TICKS the spawn interval drops by SPAWN_INTERVAL_STEP
+// ticks until it reaches MIN_SPAWN_INTERVAL.
+const int DIFFICULTY_STEP_TICKS = 20 * 1000 / SIMULATION_STEP_MS;
+const int SPAWN_INTERVAL_STEP = 4;
+const int MIN_SPAWN_INTERVAL = SPAWN_INTERVAL / 2;
+const int SHAKE_INTENSITY = 10;
+const int SHAKE_TICKS = 12;
+
+enum InputType { INPUT_MOUSE_DOWN, INPUT_MOUSE_UP, INPUT_MOUSE_MOVE, INPUT_RESTART };
+
+struct InputEvent {
+    InputType type;
+    int x, y;
+};
+
+struct RenderObject {
+    int x, y;
+    ObjectType type;
+};
+
+// Everything the renderer needs for one simulated frame. Buffers are sized
+// for full pools up front so publishing never allocates.
+struct FrameSnapshot {
+    FrameSnapshot() {
+        objects.reserve(MAX_OBJECTS);
+        particles.reserve();
+    }
+
+    std::vector<RenderObject> objects;
+    Trail trail;
+    ParticleFrame particles;
+    int score = 0;
+    int hp = START_HP;
+    bool gameOver = false;
+    // Window offset of the running screen shake, if any.
+    int shakeX = 0, shakeY = 0;
+    unsigned step = 0;
+    Uint64 published = 0;
+};
+
+// Runs the game on its own thread at a fixed SIMULATION_STEP_MS step. SDL
+// only delivers events on the main thread, so the main thread forwards input
+// through a queue and renders whatever snapshot is newest; neither side waits
+// on the other.
+class Simulation {
+public:
+    Simulation() = default;
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+    ~Simulation() { stop(); }
+
+    void start(JobSystem& jobs, SoundSystem& sound, MusicPlayer& music);
+    void stop();
+    bool isRunning() const { return thread.joinable(); }
+
+    // Main thread only.
+    void post(const InputEvent& event);
+    // Fraction of the usual particle count slices and bomb hits emit.
+    void setEffectDensity(float density) { effectDensity.store(density, std::memory_order_relaxed); }
+    // Render thread only. Returns true when a newer snapshot was picked up.
+    bool acquire() { return snapshots.update(); }
+    const FrameSnapshot& current() const { return snapshots.front(); }
+
+private:
+    void run();
+    void step();
+    void reset();
+    void spawn();
+    void publish();
+    // Consumers of the step's events, run after the object loop.
+    void applyScoring();
+    void applyEffects();
+    void spawnFragments();
+    void playEventSounds();
+    void recordStats();
+    // Scripts run on the simulation tick.
+    Script spawnWaves();
+    Script rampDifficulty();
+    // Runs while shakeTicksLeft is positive; bomb hits top it up.
+    Script shake();
+
+    JobSystem* jobs = nullptr;
+    SoundSystem* sound = nullptr;
+    MusicPlayer* music = nullptr;
+    FrameArena arena;
+    AllocationGuard allocationGuard;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<float> effectDensity{1.0f};
+    SpscQueue<InputEvent, INPUT_QUEUE_CAPACITY> input;
+    TripleBuffer<FrameSnapshot> snapshots;
+
+    // Owned by the simulation thread.
+    std::vector<GameObject> objects;
+    ObjectUpdater objectUpdater;
+    ParticleSystem particles;
+    Trail trail;
+    GameEventBuffer events;
+    ScriptScheduler scripts;
+    Random random;
+    int spawnInterval = SPAWN_INTERVAL;
+    int score = 0;
+    int hp = START_HP;
+    bool gameOver = false;
+    int shakeX = 0, shakeY = 0;
+    int shakeIntensity = SHAKE_INTENSITY, shakeTicksLeft = 0;
+    bool shaking = false;
+    unsigned steps = 0;
+    int fruitSliced = 0, fruitMissed = 0, bombsHit = 0;
+    bool mouseDown = false;
+    int mouseX = 0, mouseY = 0, prevMouseX = 0, prevMouseY = 0;
+};
+
+// How old the presented snapshot was when SDL_RenderPresent returned.
+struct SnapshotStats {
+    int frames = 0;
+    int repeated = 0;
+    double totalAgeMs = 0;
+    double maxAgeMs = 0;
+
+    void record(const FrameSnapshot& frame, bool fresh);
+    void print() const;
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "spsc_queue.h"
+
+enum SoundId { SOUND_SLICE, SOUND_BOMB, SOUND_GAME_OVER, SOUND_COUNT };
+
+const int MAX_VOICES = 32;
+const int SOUND_QUEUE_CAPACITY = 1024;
+const int SOUND_MIX_BLOCK = 256;
+const int AUDIO_STRESS_PER_FRAME = 8;
+
+struct SoundCommand {
+    SoundId sound;
+    float volume;
+    float pan;
+    float pitch;
+};
+
+struct SoundStats {
+    int posted;
+    int dropped;
+    int played;
+    int stolen;
+    int callbacks;
+    double mixAverageUs;
+    double mixMaxUs;
+    double bufferMs;
+};
+
+// Maps a playfield x coordinate to a stereo pan in [-1, 1].
+inline float panForX(float x, float width) {
+    return x / width * 2.0f - 1.0f;
+}
+
+// Sound effects mixed by our own SIMD mixer in SDL_mixer's post-mix callback,
+// on top of the music. The game thread only pushes commands onto a lock-free
+// queue that the callback drains, so a frame never waits on the audio device
+// lock. Voices are capped at MAX_VOICES: a sound past its own limit steals its
+// oldest voice, otherwise the oldest voice of equal or lower priority goes.
+class SoundSystem {
+public:
+    bool init(int bufferSamples);
+    void shutdown();
+    bool isOpen() const { return open; }
+
+    bool play(SoundId sound, float pan = 0.0f, int volume = MIX_MAX_VOLUME);
+    SoundStats stats() const;
+
+private:
+    struct Voice {
+        const Sint16* samples = nullptr;
+        int length = 0;
+        double position = 0;
+        float step = 1.0f;
+        float gainLeft = 0, gainRight = 0;
+        int sound = -1;
+        Uint64 started = 0;
+    };
+
+    static void postMix(void* userdata, Uint8* stream, int length);
+    void mix(Sint16* out, int frames);
+    void start(const SoundCommand& command);
+    int pickVoice(SoundId sound);
+    void mixVoice(Voice& voice, float* left, float* right, int frames);
+
+    bool open = false;
+    int outputChannels = 2;
+    int frequency = 0;
+    std::array<std::vector<Sint16>, SOUND_COUNT> pcm;
+
+    // Owned by the audio callback.
+    std::array<Voice, MAX_VOICES> voices;
+    Uint64 sequence = 0;
+    alignas(16) float left[SOUND_MIX_BLOCK];
+    alignas(16) float right[SOUND_MIX_BLOCK];
+
+    // Owned by the game thread.
+    Uint32 random = 0x9E3779B9u;
+
+    SpscQueue<SoundCommand, SOUND_QUEUE_CAPACITY> queue;
+    std::atomic<int> posted{0};
+    std::atomic<int> dropped{0};
+    std::atomic<int> played{0};
+    std::atomic<int> stolen{0};
+    std::atomic<int> callbacks{0};
+    std::atomic<Uint64> mixTicks{0};
+    std::atomic<Uint64> mixMaxTicks{0};
+    std::atomic<int> bufferFrames{0};
+};
+
+// Fires AUDIO_STRESS_PER_FRAME slice sounds every 16 ms frame and reports how
+// long posting took, whether any frame overran and the mixer time per
+// callback. Run it on the dummy or disk audio driver on machines without
+// sound hardware.
+void runAudioStress(int frames, int bufferSamples);
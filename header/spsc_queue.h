@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded single-producer/single-consumer queue. push() and pop() never
+// block or allocate; push() fails when the queue is full. Capacity must be a
+// power of two.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    bool push(const T& item) {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - headCache == Capacity) {
+            headCache = head.load(std::memory_order_acquire);
+            if (tail - headCache == Capacity) return false;
+        }
+        items[tail & (Capacity - 1)] = item;
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        if (head == tailCache) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (head == tailCache) return false;
+        }
+        item = items[head & (Capacity - 1)];
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+private:
+    // Producer and consumer indices live on separate cache lines so the two
+    // threads do not false-share.
+    alignas(64) std::atomic<size_t> head{0};
+    size_t tailCache = 0;
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t headCache = 0;
+    alignas(64) std::array<T, Capacity> items{};
+};
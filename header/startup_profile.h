@@ -0,0 +1,33 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+// Timeline of process startup for --startup-bench. Times are milliseconds
+// since the profile was constructed, which main() does before anything else.
+class StartupProfile {
+public:
+    StartupProfile();
+
+    Uint64 now() const { return SDL_GetPerformanceCounter(); }
+    // Records a step that started at the given counter value and ends now.
+    void record(const std::string& name, Uint64 start);
+    // Records a step that took durationMs and ends now.
+    void add(const std::string& name, double durationMs);
+    double elapsedMs() const;
+
+    void print() const;
+    bool writeJson(const std::string& path) const;
+
+private:
+    struct Event {
+        std::string name;
+        double startMs;
+        double durationMs;
+    };
+
+    double toMs(Uint64 ticks) const;
+
+    Uint64 origin;
+    std::vector<Event> events;
+};
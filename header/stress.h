@@ -0,0 +1,35 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+#include "game.h"
+#include "job_system.h"
+
+const int STRESS_MIN_ENTITIES = 10;
+// Measured time after which a sweep point stops, once it has STRESS_MIN_FRAMES.
+const double STRESS_POINT_BUDGET_MS = 3000;
+const int STRESS_MIN_FRAMES = 3;
+// Rendering is skipped for the rest of the sweep once a frame takes this long.
+const double STRESS_RENDER_LIMIT_MS = 1000;
+
+struct StressConfig {
+    int width = SCREEN_WIDTH;
+    int height = SCREEN_HEIGHT;
+    int maxEntities = 1000000;
+    // Relative shares of fruit, bombs and fragments in the population.
+    int fruitShare = 60, bombShare = 20, fragmentShare = 20;
+    // Objects respawned per frame to refill the population; 0 refills at once.
+    int spawnRate = 0;
+    int frames = 300;
+    bool render = true;
+    std::string renderer;
+    std::string csvPath = "stress.csv";
+};
+
+// Sweeps the entity count from STRESS_MIN_ENTITIES to maxEntities in steps of
+// sqrt(10). Each point keeps that many objects alive on a width x height
+// playfield, cuts through them with a scripted blade, and times the object
+// update, the reactions to slices and bomb hits, and rendering. Writes one
+// CSV row per point, including the particles and fragments the reactions
+// produced and dropped, and prints where each stage stops scaling linearly.
+// The slice stage only counts up to the first point that dropped anything.
+bool runStressScene(const StressConfig& config, SDL_Surface* background, SDL_Surface* bomb, JobSystem& jobs);
@@ -0,0 +1,39 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+#include "assets.h"
+#include "baked_font.h"
+
+// Glyphs draw() has room for without growing its vertex buffers.
+const int FONT_DRAW_RESERVE = 128;
+
+const BakedFont* findBakedFont(const std::string& name, int size);
+
+// A font at one size. Fonts baked by tools/bake_fonts.cpp are drawn from the
+// atlas compiled into the binary and never touch SDL_ttf; any other size is
+// opened through the AssetManager, initializing SDL_ttf on first use.
+class Font {
+public:
+    bool open(AssetManager& assets, const std::string& name, int size, bool allowBaked = true);
+    void close();
+    bool isBaked() const { return baked != nullptr; }
+
+    int height() const;
+    void measure(const char* text, int& w, int& h) const;
+    // Straight-alpha ARGB8888 surface, like TTF_RenderText_Blended.
+    SDL_Surface* renderSurface(const char* text, SDL_Color color) const;
+    void draw(SDL_Renderer* renderer, const char* text, int x, int y, SDL_Color color);
+
+private:
+    const BakedGlyph* glyph(char c) const;
+    int kerning(char first, char second) const;
+    bool createAtlas(SDL_Renderer* renderer);
+
+    const BakedFont* baked = nullptr;
+    FontHandle ttf;
+    SDL_Renderer* atlasRenderer = nullptr;
+    SDL_Texture* atlasTexture = nullptr;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
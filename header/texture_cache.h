@@ -0,0 +1,52 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+const char TEXTURE_CACHE_MAGIC[4] = {'F', 'T', 'E', 'X'};
+const Uint32 TEXTURE_CACHE_VERSION = 1;
+
+struct TextureCacheHeader {
+    char magic[4];
+    Uint32 version;
+    Uint64 sourceHash;
+    Uint32 format;
+    Sint32 w, h;
+    Uint32 premultiplied;
+    Uint64 compressedSize;
+};
+
+// Pixels of one asset in the renderer's native format, zstd-compressed.
+struct CachedTexture {
+    Uint32 format = 0;
+    int w = 0, h = 0;
+    bool premultiplied = false;
+    std::vector<Uint8> compressed;
+};
+
+// Keeps decoded textures on disk so later launches skip PNG/JPEG decoding and
+// format conversion. Entries are keyed by asset name and invalidated when the
+// hash of the source bytes changes. init() and the create functions must run
+// on the render thread; lookup/convert/store are safe from workers.
+class TextureCache {
+public:
+    bool init(SDL_Renderer* renderer);
+
+    static Uint64 hash(const void* data, size_t size);
+    bool lookup(const std::string& name, Uint64 sourceHash, CachedTexture& cached) const;
+    SDL_Surface* convert(SDL_Surface* source) const;
+    void store(const std::string& name, Uint64 sourceHash, SDL_Surface* converted) const;
+
+    SDL_Texture* createTexture(const CachedTexture& cached) const;
+    SDL_Texture* createTexture(SDL_Surface* converted) const;
+
+private:
+    std::string pathFor(const std::string& name) const;
+    void applyBlendMode(SDL_Texture* texture, bool premultiplied) const;
+
+    SDL_Renderer* renderer = nullptr;
+    std::string directory;
+    Uint32 nativeFormat = SDL_PIXELFORMAT_ARGB8888;
+    bool premultiply = false;
+    SDL_BlendMode premultipliedBlend = SDL_BLENDMODE_BLEND;
+};
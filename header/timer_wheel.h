@@ -0,0 +1,54 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <vector>
+
+const int TIMER_WHEEL_BITS = 6;
+const int TIMER_WHEEL_SLOTS = 1 << TIMER_WHEEL_BITS;
+const int TIMER_WHEEL_LEVELS = 4;
+// Longer delays are clamped; at 16 ms a tick this is about three days.
+const Uint32 TIMER_MAX_DELAY = (1u << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1;
+
+// Hierarchical timer wheel advanced once per simulation tick. Level 0 has a
+// slot per tick for the next 64 ticks, each level above covers 64 times more
+// with coarser slots, and a slot's timers move down a level when the wheel
+// reaches it. Scheduling and firing are O(1); timers cost nothing per tick
+// until their slot comes up. Timers live in a pool sized by init(), so
+// scheduling never allocates. Not thread-safe.
+class TimerWheel {
+public:
+    typedef void (*Callback)(void* data);
+
+    void init(int capacity);
+    // Fires callback(data) delay ticks from now (at least one). Returns false
+    // when the pool is exhausted.
+    bool schedule(Uint32 delay, Callback callback, void* data);
+    // Moves to the next tick and fires everything due on it. Timers due on
+    // the same tick fire in a deterministic order. Callbacks may schedule more
+    // timers.
+    void advance();
+    // Drops every pending timer without firing it.
+    void clear();
+
+    Uint64 now() const { return current; }
+    int pending() const { return pendingCount; }
+
+private:
+    struct Timer {
+        Uint64 expires;
+        Callback callback;
+        void* data;
+        int next;
+    };
+    struct Slot {
+        int head = -1, tail = -1;
+    };
+
+    void insert(int index);
+    int take(int level, int slot);
+
+    std::vector<Timer> timers;
+    int freeList = -1;
+    Slot slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    Uint64 current = 0;
+    int pendingCount = 0;
+};
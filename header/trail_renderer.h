@@ -0,0 +1,25 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <array>
+#include "game.h"
+
+const int TRAIL_SUBDIVISIONS = 4;
+const int TRAIL_MAX_SAMPLES = (TRAIL_LENGTH - 1) * TRAIL_SUBDIVISIONS + 1;
+const float TRAIL_WIDTH = 14.0f;
+
+// Draws the blade trail as a tapered, fading ribbon in one SDL_RenderGeometry call.
+class TrailRenderer {
+public:
+    TrailRenderer();
+
+    // Draws subdivisions Catmull-Rom samples per trail segment, up to
+    // TRAIL_SUBDIVISIONS; 1 draws the raw points.
+    void render(SDL_Renderer* renderer, const Trail& trail, int subdivisions);
+
+private:
+    int buildSamples(const Trail& trail, int subdivisions);
+
+    std::array<SDL_FPoint, TRAIL_MAX_SAMPLES> samples;
+    std::array<SDL_Vertex, 2 * TRAIL_MAX_SAMPLES> vertices;
+    std::array<int, 6 * (TRAIL_MAX_SAMPLES - 1)> indices;
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+
+// Lock-free triple buffer between one writer and one reader. The writer fills
+// back() and publishes it; the reader picks up the newest published value with
+// update(). Neither side ever waits: the writer always has a free slot, and
+// the reader keeps its current slot until a newer one exists.
+template <typename T>
+class TripleBuffer {
+public:
+    T& back() { return slots[backIndex]; }
+
+    void publish() {
+        backIndex = ready.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Returns true when front() changed.
+    bool update() {
+        if (!(ready.load(std::memory_order_relaxed) & FRESH)) return false;
+        frontIndex = ready.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static const int FRESH = 4;
+    static const int INDEX_MASK = 3;
+
+    T slots[3];
+    int backIndex = 0;
+    int frontIndex = 1;
+    std::atomic<int> ready{2};
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include "assets.h"
+#include "text.h"
+
+const Uint32 MENU_IDLE_TIMEOUT = 1000;
+const int LOADING_BATCH = 2;
+
+// A text button that owns its texture. hitRect never changes and is where the
+// button is drawn normally; while hovered it is drawn at hoverRect, hitRect
+// shrunk to 90% about its center.
+struct Button {
+    SDL_Texture* texture = nullptr;
+    SDL_Rect hitRect = {0, 0, 0, 0};
+    SDL_Rect hoverRect = {0, 0, 0, 0};
+    bool hovered = false;
+
+    bool contains(int x, int y) const {
+        return x >= hitRect.x && x <= hitRect.x + hitRect.w && y >= hitRect.y && y <= hitRect.y + hitRect.h;
+    }
+};
+
+bool createButton(SDL_Renderer* renderer, const Font& font, const char* label, int centerX, int y, Button& button);
+void destroyButton(Button& button);
+
+// Shows a progress bar until every requested asset is ready. Returns false if
+// the window was closed first. The first present is recorded in profile.
+bool runLoadingScreen(SDL_Renderer* renderer, AssetManager& assets, StartupProfile* profile = nullptr);
+
+enum MenuAction { MENU_NONE, MENU_START, MENU_EXIT };
+
+// Retained main menu: everything is built once, and render() only redraws
+// after hover, exposure or input changed something.
+class Menu {
+public:
+    bool init(SDL_Renderer* renderer, const Font& font, const TextureHandle& background);
+    void shutdown();
+
+    MenuAction handleEvent(const SDL_Event& e);
+    void invalidate() { dirty = true; }
+    void render();
+
+private:
+    bool updateHover(int x, int y);
+
+    SDL_Renderer* renderer = nullptr;
+    TextureHandle background;
+    Button start;
+    Button exit;
+    bool dirty = true;
+};
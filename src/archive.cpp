@@ -0,0 +1,143 @@
+#include "archive.h"
+#include <zstd.h>
+#include <cstring>
+#include "log.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AssetArchive::~AssetArchive() {
+    close();
+}
+
+#ifdef _WIN32
+bool AssetArchive::map(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = NULL;
+    const void* view = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+    }
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    base = static_cast<const Uint8*>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void AssetArchive::unmap() {
+    if (base) UnmapViewOfFile(base);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+}
+#else
+bool AssetArchive::map(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+    base = static_cast<const Uint8*>(view);
+    size = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+void AssetArchive::unmap() {
+    if (base) munmap(const_cast<Uint8*>(base), size);
+}
+#endif
+
+bool AssetArchive::open(const std::string& path) {
+    close();
+    if (!map(path)) return false;
+
+    const PackHeader* header = reinterpret_cast<const PackHeader*>(base);
+    bool valid = size >= sizeof(PackHeader) && memcmp(header->magic, PACK_MAGIC, sizeof(header->magic)) == 0 &&
+                 header->version == PACK_VERSION &&
+                 size >= sizeof(PackHeader) + static_cast<size_t>(header->entryCount) * sizeof(PackEntry);
+    if (valid) {
+        entries = reinterpret_cast<const PackEntry*>(base + sizeof(PackHeader));
+        entryCount = header->entryCount;
+        for (Uint32 i = 0; i < entryCount && valid; ++i) {
+            valid = entries[i].offset + entries[i].storedSize <= size && entries[i].name[PACK_NAME_LENGTH - 1] == '\0';
+        }
+    }
+    if (!valid) {
+        LOG_WARN(LOG_ASSETS, "Ignoring invalid asset archive {}", path);
+        close();
+        return false;
+    }
+    decompressed.assign(entryCount, {});
+    decompressOnce.reset(new std::once_flag[entryCount]);
+    return true;
+}
+
+void AssetArchive::close() {
+    unmap();
+    base = nullptr;
+    size = 0;
+    entries = nullptr;
+    entryCount = 0;
+    decompressed.clear();
+    decompressOnce.reset();
+    decompressedTotal = 0;
+}
+
+const PackEntry* AssetArchive::find(const std::string& name) const {
+    // The packer writes entries sorted by name.
+    Uint32 low = 0, high = entryCount;
+    while (low < high) {
+        Uint32 mid = (low + high) / 2;
+        int order = strcmp(entries[mid].name, name.c_str());
+        if (order == 0) return &entries[mid];
+        if (order < 0) low = mid + 1;
+        else high = mid;
+    }
+    return nullptr;
+}
+
+SDL_RWops* AssetArchive::openEntry(const std::string& name) {
+    const PackEntry* entry = find(name);
+    if (!entry) return nullptr;
+    const Uint8* stored = base + entry->offset;
+    if (!(entry->flags & PACK_FLAG_ZSTD)) {
+        return SDL_RWFromConstMem(stored, static_cast<int>(entry->storedSize));
+    }
+
+    size_t index = entry - entries;
+    std::vector<Uint8>& raw = decompressed[index];
+    std::call_once(decompressOnce[index], [&] {
+        raw.resize(entry->rawSize);
+        size_t result = ZSTD_decompress(raw.data(), raw.size(), stored, entry->storedSize);
+        if (ZSTD_isError(result) || result != entry->rawSize) {
+            LOG_ERROR(LOG_ASSETS, "Failed to decompress {} from asset archive", name);
+            raw.clear();
+            raw.shrink_to_fit();
+            return;
+        }
+        decompressedTotal += raw.size();
+    });
+    if (raw.size() != entry->rawSize) return nullptr;
+    return SDL_RWFromConstMem(raw.data(), static_cast<int>(raw.size()));
+}
@@ -0,0 +1,405 @@
+#include "assets.h"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include "log.h"
+
+// main starts only the PNG decoder. The JPEG (libjpeg-turbo) and WebP
+// decoders start the first time an asset needs one, from whichever thread
+// decodes it; IMG_Init itself is not thread-safe, hence the lock.
+static void initImageCodec(const std::string& name) {
+    size_t dot = name.rfind('.');
+    if (dot == std::string::npos) return;
+    const char* extension = name.c_str() + dot + 1;
+    int flag = 0;
+    if (SDL_strcasecmp(extension, "jpg") == 0 || SDL_strcasecmp(extension, "jpeg") == 0) flag = IMG_INIT_JPG;
+    else if (SDL_strcasecmp(extension, "webp") == 0) flag = IMG_INIT_WEBP;
+    if (!flag) return;
+
+    static std::mutex mutex;
+    static int started = 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (started & flag) return;
+    started |= flag;
+    if ((IMG_Init(flag) & flag) == 0) {
+        LOG_WARN(LOG_ASSETS, "No decoder for {}: {}", name, IMG_GetError());
+    }
+}
+
+bool AssetManager::init(SDL_Renderer* renderer, const std::string& root) {
+    this->renderer = renderer;
+    this->root = root;
+    if (this->root.empty()) {
+        char* basePath = SDL_GetBasePath();
+        if (basePath) {
+            this->root = basePath;
+            SDL_free(basePath);
+        }
+    }
+    if (!this->root.empty() && this->root.back() != '/' && this->root.back() != '\\') {
+        this->root += '/';
+    }
+    return true;
+}
+
+void AssetManager::shutdown() {
+    // No new reloads; only finish what is already decoding.
+    queuedReloads = 0;
+    if (jobs) {
+        jobs->wait(decoding);
+        pump(pending);
+    }
+    pending = 0;
+    for (AssetEntry& entry : entries) {
+        entry.pending = false;
+        entry.reloadQueued = false;
+        unload(entry);
+        entry.evicted = false;
+        entry.refs = 0;
+    }
+}
+
+std::string AssetManager::resolve(const std::string& name) const {
+    return root + name;
+}
+
+TextureHandle AssetManager::loadTexture(const std::string& name) {
+    int id = acquire(ASSET_TEXTURE, name, 0);
+    return id >= 0 ? TextureHandle(this, id) : TextureHandle();
+}
+
+SurfaceHandle AssetManager::loadSurface(const std::string& name) {
+    int id = acquire(ASSET_SURFACE, name, 0);
+    return id >= 0 ? SurfaceHandle(this, id) : SurfaceHandle();
+}
+
+FontHandle AssetManager::loadFont(const std::string& name, int size) {
+    int id = acquire(ASSET_FONT, name, size);
+    return id >= 0 ? FontHandle(this, id) : FontHandle();
+}
+
+TextureHandle AssetManager::requestTexture(const std::string& name) {
+    int id = acquireAsync(ASSET_TEXTURE, name);
+    return id >= 0 ? TextureHandle(this, id) : TextureHandle();
+}
+
+SurfaceHandle AssetManager::requestSurface(const std::string& name) {
+    int id = acquireAsync(ASSET_SURFACE, name);
+    return id >= 0 ? SurfaceHandle(this, id) : SurfaceHandle();
+}
+
+int AssetManager::find(AssetType type, const std::string& name, int fontSize) {
+    static const char* prefixes[] = {"texture:", "surface:", "font:"};
+    std::string key = prefixes[type] + name;
+    if (type == ASSET_FONT) {
+        key += "@" + std::to_string(fontSize);
+    }
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].key == key) {
+            return static_cast<int>(i);
+        }
+    }
+    AssetEntry entry;
+    entry.key = key;
+    entry.name = name;
+    entry.path = resolve(name);
+    entry.type = type;
+    entry.fontSize = fontSize;
+    entries.push_back(entry);
+    return static_cast<int>(entries.size()) - 1;
+}
+
+int AssetManager::acquire(AssetType type, const std::string& name, int fontSize) {
+    int id = find(type, name, fontSize);
+    while (entries[id].pending) {
+        pump(pending);
+        SDL_Delay(1);
+    }
+    AssetEntry& entry = entries[id];
+    entry.evicted = false;
+    if (!entry.data && !load(entry)) {
+        return -1;
+    }
+    ++entry.refs;
+    return id;
+}
+
+int AssetManager::acquireAsync(AssetType type, const std::string& name) {
+    int id = find(type, name, 0);
+    AssetEntry& entry = entries[id];
+    if (entry.data || entry.pending) {
+        ++entry.refs;
+        return id;
+    }
+    entry.evicted = false;
+    ++entry.refs;
+    startDecode(id);
+    return id;
+}
+
+void AssetManager::startDecode(int id) {
+    AssetEntry& entry = entries[id];
+    entry.pending = true;
+    ++pending;
+    ++requested;
+
+    AssetType type = entry.type;
+    std::string name = entry.name;
+    std::string path = entry.path;
+    if (!jobs) {
+        finish(decode(id, type, name, path));
+        return;
+    }
+    jobs->submit([this, id, type, name, path] {
+        Decoded result = decode(id, type, name, path);
+        jobs->runOnMainThread([this, result = std::move(result)] { finish(result); });
+    }, &decoding);
+}
+
+// Runs in jobs as well as on the main thread, so it only touches the
+// source, the texture cache and the image decoder - never the renderer.
+AssetManager::Decoded AssetManager::decode(int id, AssetType type, const std::string& name, const std::string& path) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    Decoded result{id, nullptr, {}, false, 0};
+    SDL_RWops* source = openSource(name, path);
+    if (!source) {
+        LOG_ERROR(LOG_ASSETS, "Failed to open {}: {}", path, SDL_GetError());
+        return result;
+    }
+
+    if (type == ASSET_TEXTURE && textureCache) {
+        std::vector<Uint8> bytes;
+        Sint64 size = SDL_RWsize(source);
+        if (size > 0) {
+            bytes.resize(static_cast<size_t>(size));
+            if (SDL_RWread(source, bytes.data(), 1, bytes.size()) != bytes.size()) {
+                bytes.clear();
+            }
+        }
+        SDL_RWclose(source);
+        Uint64 sourceHash = TextureCache::hash(bytes.data(), bytes.size());
+        if (!textureCache->lookup(name, sourceHash, result.cached)) {
+            initImageCodec(name);
+            SDL_Surface* surface = IMG_Load_RW(SDL_RWFromConstMem(bytes.data(), static_cast<int>(bytes.size())), 1);
+            if (surface) {
+                result.surface = textureCache->convert(surface);
+                result.converted = result.surface != nullptr;
+                SDL_FreeSurface(surface);
+            }
+            if (result.surface) {
+                textureCache->store(name, sourceHash, result.surface);
+            }
+        }
+    } else {
+        initImageCodec(name);
+        result.surface = IMG_Load_RW(source, 1);
+    }
+
+    if (!result.surface && result.cached.compressed.empty()) {
+        LOG_ERROR(LOG_ASSETS, "Failed to load {}: {}", path, SDL_GetError());
+    }
+    result.decodeMs = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    return result;
+}
+
+void AssetManager::pump(int maxItems) {
+    for (size_t id = 0; queuedReloads > 0 && id < entries.size(); ++id) {
+        AssetEntry& entry = entries[id];
+        if (!entry.reloadQueued) continue;
+        entry.reloadQueued = false;
+        --queuedReloads;
+        if (entry.evicted && entry.refs > 0 && !entry.pending) {
+            entry.evicted = false;
+            startDecode(static_cast<int>(id));
+        }
+    }
+    if (jobs) {
+        jobs->pumpMainThread(maxItems);
+    }
+}
+
+void AssetManager::finish(const Decoded& result) {
+    AssetEntry& entry = entries[result.id];
+    entry.pending = false;
+    --pending;
+    if (entry.refs == 0) {
+        SDL_FreeSurface(result.surface);
+        return;
+    }
+    if (!complete(entry, result)) {
+        entry.refs = 0;
+    }
+}
+
+// Turns a decode result into the entry's resident data; takes ownership of
+// the surface.
+bool AssetManager::complete(AssetEntry& entry, const Decoded& result) {
+    if (!result.surface && result.cached.compressed.empty()) {
+        return false;
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    if (entry.type == ASSET_TEXTURE) {
+        SDL_Texture* texture;
+        if (!result.cached.compressed.empty()) {
+            texture = textureCache->createTexture(result.cached);
+        } else if (result.converted) {
+            texture = textureCache->createTexture(result.surface);
+        } else {
+            texture = SDL_CreateTextureFromSurface(renderer, result.surface);
+        }
+        SDL_FreeSurface(result.surface);
+        if (!texture) {
+            LOG_ERROR(LOG_ASSETS, "Failed to create texture for {}: {}", entry.path, SDL_GetError());
+            return false;
+        }
+        Uint32 format;
+        int w, h;
+        SDL_QueryTexture(texture, &format, NULL, &w, &h);
+        entry.bytes = static_cast<size_t>(w) * h * SDL_BYTESPERPIXEL(format);
+        entry.data = texture;
+        entry.lastUse = frame;
+        textureBytes += entry.bytes;
+        peakTextureBytes = std::max(peakTextureBytes, textureBytes);
+    } else {
+        entry.bytes = static_cast<size_t>(result.surface->pitch) * result.surface->h;
+        entry.data = result.surface;
+    }
+    entry.loadMs = result.decodeMs + (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    if (startupProfile) startupProfile->add("load " + entry.key, entry.loadMs);
+    return true;
+}
+
+SDL_RWops* AssetManager::openSource(const std::string& name, const std::string& path) {
+    if (archive && archive->isOpen()) {
+        SDL_RWops* rw = archive->openEntry(name);
+        if (rw) return rw;
+    }
+    return SDL_RWFromFile(path.c_str(), "rb");
+}
+
+bool AssetManager::load(AssetEntry& entry) {
+    if (entry.type != ASSET_FONT) {
+        return complete(entry, decode(-1, entry.type, entry.name, entry.path));
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    SDL_RWops* source = openSource(entry.name, entry.path);
+    if (!source) {
+        LOG_ERROR(LOG_ASSETS, "Failed to open {}: {}", entry.path, SDL_GetError());
+        return false;
+    }
+    Sint64 fileSize = SDL_RWsize(source);
+    TTF_Font* font = TTF_OpenFontRW(source, 1, entry.fontSize);
+    if (font) {
+        entry.bytes = fileSize > 0 ? static_cast<size_t>(fileSize) : 0;
+    }
+    entry.data = font;
+    entry.loadMs = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    if (!entry.data) {
+        LOG_ERROR(LOG_ASSETS, "Failed to load {}: {}", entry.path, SDL_GetError());
+        return false;
+    }
+    if (startupProfile) startupProfile->add("load " + entry.key, entry.loadMs);
+    return true;
+}
+
+void AssetManager::unload(AssetEntry& entry) {
+    if (!entry.data) return;
+    switch (entry.type) {
+    case ASSET_TEXTURE:
+        SDL_DestroyTexture(static_cast<SDL_Texture*>(entry.data));
+        textureBytes -= entry.bytes;
+        break;
+    case ASSET_SURFACE:
+        SDL_FreeSurface(static_cast<SDL_Surface*>(entry.data));
+        break;
+    case ASSET_FONT:
+        TTF_CloseFont(static_cast<TTF_Font*>(entry.data));
+        break;
+    }
+    entry.data = nullptr;
+    entry.bytes = 0;
+}
+
+void AssetManager::retain(int id) {
+    if (id >= 0 && id < static_cast<int>(entries.size()) && (entries[id].data || entries[id].pending || entries[id].evicted)) {
+        ++entries[id].refs;
+    }
+}
+
+void AssetManager::release(int id) {
+    if (id < 0 || id >= static_cast<int>(entries.size())) return;
+    AssetEntry& entry = entries[id];
+    if (entry.refs > 0 && --entry.refs == 0) {
+        unload(entry);
+        entry.evicted = false;
+    }
+}
+
+void* AssetManager::data(int id) {
+    if (id < 0 || id >= static_cast<int>(entries.size())) return nullptr;
+    AssetEntry& entry = entries[id];
+    if (entry.evicted && entry.refs > 0 && !entry.pending && !entry.reloadQueued) {
+        entry.reloadQueued = true;
+        ++queuedReloads;
+    }
+    entry.lastUse = frame;
+    return entry.data;
+}
+
+void AssetManager::endFrame() {
+    trimTextures();
+    ++frame;
+}
+
+void AssetManager::trimTextures() {
+    while (textureBudget > 0 && textureBytes > textureBudget) {
+        AssetEntry* victim = nullptr;
+        for (AssetEntry& entry : entries) {
+            if (entry.type == ASSET_TEXTURE && entry.data && entry.lastUse != frame &&
+                (!victim || entry.lastUse < victim->lastUse)) {
+                victim = &entry;
+            }
+        }
+        if (!victim) return;
+        evictedTextureBytes += victim->bytes;
+        ++evictions;
+        unload(*victim);
+        victim->evicted = true;
+    }
+}
+
+TextureResidency AssetManager::textureResidency() const {
+    return {textureBudget, textureBytes, peakTextureBytes, evictedTextureBytes, evictions};
+}
+
+size_t AssetManager::residentBytes() const {
+    size_t total = 0;
+    for (const AssetEntry& entry : entries) {
+        total += entry.bytes;
+    }
+    return total;
+}
+
+void AssetManager::report() const {
+    std::printf("%-40s %5s %10s %12s\n", "asset", "refs", "load ms", "resident KB");
+    double totalMs = 0;
+    for (const AssetEntry& entry : entries) {
+        std::printf("%-40s %5d %10.2f %12.1f\n", entry.key.c_str(), entry.refs, entry.loadMs, entry.bytes / 1024.0);
+        totalMs += entry.loadMs;
+    }
+    std::printf("%-40s %5s %10.2f %12.1f\n", "total", "", totalMs, residentBytes() / 1024.0);
+    std::printf("textures: %.1f KB resident, %.1f KB peak, %.1f KB evicted in %d evictions",
+                textureBytes / 1024.0, peakTextureBytes / 1024.0, evictedTextureBytes / 1024.0, evictions);
+    if (textureBudget > 0) {
+        std::printf(", budget %.1f KB", textureBudget / 1024.0);
+    }
+    std::printf("\n");
+    if (archive && archive->isOpen()) {
+        std::printf("archive: %.1f KB decompressed, kept until the archive closes\n", archive->decompressedBytes() / 1024.0);
+    }
+    std::fflush(stdout);
+}
@@ -0,0 +1,317 @@
+#include "cpu_raster.h"
+#include <algorithm>
+#include <cstring>
+#include "log.h"
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+static void fillSpanScalar(Uint32* dst, int count, Uint32 color) {
+    for (int i = 0; i < count; ++i) {
+        dst[i] = color;
+    }
+}
+
+#if defined(__SSE2__)
+static void fillSpanSse2(Uint32* dst, int count, Uint32 color) {
+    __m128i value = _mm_set1_epi32(static_cast<int>(color));
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), value);
+    }
+    for (; i < count; ++i) {
+        dst[i] = color;
+    }
+}
+
+__attribute__((target("avx2"))) static void fillSpanAvx2(Uint32* dst, int count, Uint32 color) {
+    __m256i value = _mm256_set1_epi32(static_cast<int>(color));
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), value);
+    }
+    for (; i < count; ++i) {
+        dst[i] = color;
+    }
+}
+#endif
+
+static void (*fillSpan)(Uint32* dst, int count, Uint32 color) = fillSpanScalar;
+
+// dst = src + dst * (255 - srcAlpha) / 255, per channel, with src premultiplied.
+static inline Uint32 blendPixel(Uint32 dst, Uint32 src) {
+    Uint32 inv = 255 - (src >> 24);
+    Uint32 result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        Uint32 t = ((dst >> shift) & 0xFF) * inv + 128;
+        Uint32 channel = ((src >> shift) & 0xFF) + ((t + (t >> 8)) >> 8);
+        result |= std::min<Uint32>(channel, 255) << shift;
+    }
+    return result;
+}
+
+static void blendSpan(Uint32* dst, const Uint32* src, int count) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i half = _mm_set1_epi16(128);
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i slo = _mm_unpacklo_epi8(s, zero);
+        __m128i shi = _mm_unpackhi_epi8(s, zero);
+        __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(slo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(shi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i tlo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(full, alo)), half);
+        __m128i thi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(full, ahi)), half);
+        tlo = _mm_srli_epi16(_mm_add_epi16(tlo, _mm_srli_epi16(tlo, 8)), 8);
+        thi = _mm_srli_epi16(_mm_add_epi16(thi, _mm_srli_epi16(thi, 8)), 8);
+        __m128i blended = _mm_adds_epu8(s, _mm_packus_epi16(tlo, thi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), blended);
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = blendPixel(dst[i], src[i]);
+    }
+}
+
+bool makeSprite(SDL_Surface* surface, int w, int h, Sprite& sprite) {
+    if (!surface || w <= 0 || h <= 0) return false;
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_Surface* scaled = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!converted || !scaled) {
+        SDL_FreeSurface(converted);
+        SDL_FreeSurface(scaled);
+        return false;
+    }
+    SDL_SetSurfaceBlendMode(converted, SDL_BLENDMODE_NONE);
+    SDL_BlitScaled(converted, NULL, scaled, NULL);
+
+    sprite.w = w;
+    sprite.h = h;
+    ++sprite.version;
+    sprite.pixels.resize(static_cast<size_t>(w) * h);
+    for (int y = 0; y < h; ++y) {
+        const Uint32* row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(scaled->pixels) + y * scaled->pitch);
+        for (int x = 0; x < w; ++x) {
+            Uint32 pixel = row[x];
+            Uint32 a = pixel >> 24;
+            Uint32 r = ((pixel >> 16) & 0xFF) * a / 255;
+            Uint32 g = ((pixel >> 8) & 0xFF) * a / 255;
+            Uint32 b = (pixel & 0xFF) * a / 255;
+            sprite.pixels[y * w + x] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+    SDL_FreeSurface(scaled);
+    SDL_FreeSurface(converted);
+    return true;
+}
+
+bool CpuRasterizer::init(SDL_Renderer* renderer, SDL_Surface* backgroundSurface, JobSystem* jobs, bool dirtyRects) {
+    this->renderer = renderer;
+    this->jobs = jobs;
+    this->dirtyRects = dirtyRects;
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (!texture) {
+        LOG_ERROR(LOG_RENDER, "Failed to create streaming texture: {}", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+
+    Sprite scaled;
+    if (makeSprite(backgroundSurface, SCREEN_WIDTH, SCREEN_HEIGHT, scaled)) {
+        background = std::move(scaled.pixels);
+    } else {
+        background.assign(static_cast<size_t>(SCREEN_WIDTH) * SCREEN_HEIGHT, 0xFF000000);
+    }
+    if (dirtyRects) {
+        frame.assign(background.size(), 0);
+        fullRedraw = true;
+    }
+
+#if defined(__SSE2__)
+    fillSpan = SDL_HasAVX2() ? fillSpanAvx2 : fillSpanSse2;
+#endif
+
+    // Room for every pooled object plus the HUD, so frames never grow them.
+    commands.reserve(MAX_OBJECTS + 2);
+    previousCommands.reserve(MAX_OBJECTS + 2);
+    dirty.reserve(MAX_DIRTY_RECTS + 2);
+    tiles.clear();
+    for (int y = 0; y < SCREEN_HEIGHT; y += RASTER_TILE_HEIGHT) {
+        tiles.push_back({0, y, SCREEN_WIDTH, std::min(RASTER_TILE_HEIGHT, SCREEN_HEIGHT - y)});
+    }
+    return true;
+}
+
+void CpuRasterizer::shutdown() {
+    SDL_DestroyTexture(texture);
+    texture = nullptr;
+}
+
+void CpuRasterizer::beginFrame() {
+    commands.clear();
+}
+
+void CpuRasterizer::addDisc(int centerX, int centerY, Uint32 color) {
+    commands.push_back({nullptr, centerX, centerY, 2 * DISC_RADIUS + 1, 2 * DISC_RADIUS + 1, color, 0});
+}
+
+void CpuRasterizer::addSprite(const Sprite* sprite, int x, int y) {
+    if (sprite && sprite->w > 0) {
+        commands.push_back({sprite, x, y, sprite->w, sprite->h, 0, sprite->version});
+    }
+}
+
+SDL_Rect CpuRasterizer::bounds(const Command& command) {
+    if (!command.sprite) {
+        return {command.x - DISC_RADIUS, command.y - DISC_RADIUS, command.w, command.h};
+    }
+    return {command.x, command.y, command.w, command.h};
+}
+
+static int area(const SDL_Rect& rect) {
+    return rect.w * rect.h;
+}
+
+// Dirty regions are the old and new bounds of every command that changed since
+// last frame. Rects are merged until none overlap (so tiles can be filled in
+// parallel) and merging further would not add overdraw. Returns false when the
+// scene is too busy for rect tracking to pay off.
+bool CpuRasterizer::collectDirtyRects() {
+    const SDL_Rect screen = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+    dirty.clear();
+    auto addDirty = [&](const Command& command) {
+        SDL_Rect rect = bounds(command);
+        SDL_Rect clipped;
+        if (SDL_IntersectRect(&rect, &screen, &clipped)) {
+            dirty.push_back(clipped);
+        }
+    };
+    size_t count = std::max(commands.size(), previousCommands.size());
+    for (size_t i = 0; i < count; ++i) {
+        bool hasPrevious = i < previousCommands.size();
+        bool hasCurrent = i < commands.size();
+        if (hasPrevious && hasCurrent) {
+            const Command& a = previousCommands[i];
+            const Command& b = commands[i];
+            if (a.sprite == b.sprite && a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h &&
+                a.color == b.color && a.version == b.version) {
+                continue;
+            }
+        }
+        if (hasPrevious) addDirty(previousCommands[i]);
+        if (hasCurrent) addDirty(commands[i]);
+        if (dirty.size() > MAX_DIRTY_RECTS) return false;
+    }
+
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < dirty.size() && !merged; ++i) {
+            for (size_t j = i + 1; j < dirty.size(); ++j) {
+                SDL_Rect joined;
+                SDL_UnionRect(&dirty[i], &dirty[j], &joined);
+                if (SDL_HasIntersection(&dirty[i], &dirty[j]) || area(joined) <= area(dirty[i]) + area(dirty[j])) {
+                    dirty[i] = joined;
+                    dirty[j] = dirty.back();
+                    dirty.pop_back();
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void CpuRasterizer::rasterizeRect(const SDL_Rect& clip) {
+    int x0 = clip.x;
+    int x1 = clip.x + clip.w;
+    int y0 = clip.y;
+    int y1 = clip.y + clip.h;
+    for (int y = y0; y < y1; ++y) {
+        memcpy(framePixels + y * framePitch + x0, &background[static_cast<size_t>(y) * SCREEN_WIDTH + x0], clip.w * sizeof(Uint32));
+    }
+
+    for (const Command& command : commands) {
+        if (!command.sprite) {
+            int top = std::max(command.y - DISC_RADIUS, y0);
+            int bottom = std::min(command.y + DISC_RADIUS + 1, y1);
+            for (int y = top; y < bottom; ++y) {
+                int half = DISC_SPANS[y - command.y + DISC_RADIUS];
+                int left = std::max(command.x - half, x0);
+                int right = std::min(command.x + half + 1, x1);
+                if (left < right) {
+                    fillSpan(framePixels + y * framePitch + left, right - left, command.color);
+                }
+            }
+        } else {
+            const Sprite& sprite = *command.sprite;
+            int top = std::max(command.y, y0);
+            int bottom = std::min(command.y + sprite.h, y1);
+            int left = std::max(command.x, x0);
+            int right = std::min(command.x + sprite.w, x1);
+            if (left >= right) continue;
+            for (int y = top; y < bottom; ++y) {
+                const Uint32* src = &sprite.pixels[static_cast<size_t>(y - command.y) * sprite.w + (left - command.x)];
+                blendSpan(framePixels + y * framePitch + left, src, right - left);
+            }
+        }
+    }
+}
+
+void CpuRasterizer::runWork() {
+    filledPixels = 0;
+    for (const SDL_Rect& rect : *work) {
+        filledPixels += area(rect);
+    }
+    auto rasterize = [this](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            rasterizeRect((*work)[i]);
+        }
+    };
+    int count = static_cast<int>(work->size());
+    if (jobs) {
+        jobs->parallelFor(0, count, 1, rasterize);
+    } else {
+        rasterize(0, count);
+    }
+}
+
+void CpuRasterizer::endFrame() {
+    if (!dirtyRects) {
+        void* pixels = nullptr;
+        int pitch = 0;
+        if (SDL_LockTexture(texture, NULL, &pixels, &pitch) != 0) {
+            return;
+        }
+        framePixels = static_cast<Uint32*>(pixels);
+        framePitch = pitch / static_cast<int>(sizeof(Uint32));
+        work = &tiles;
+        runWork();
+        SDL_UnlockTexture(texture);
+    } else {
+        bool tracked = collectDirtyRects();
+        int dirtyArea = 0;
+        for (const SDL_Rect& rect : dirty) {
+            dirtyArea += area(rect);
+        }
+        bool redrawAll = fullRedraw || !tracked || dirtyArea * 2 > SCREEN_WIDTH * SCREEN_HEIGHT;
+        framePixels = frame.data();
+        framePitch = SCREEN_WIDTH;
+        work = redrawAll ? &tiles : &dirty;
+        runWork();
+        if (redrawAll) {
+            SDL_UpdateTexture(texture, NULL, frame.data(), SCREEN_WIDTH * sizeof(Uint32));
+        } else {
+            for (const SDL_Rect& rect : dirty) {
+                SDL_UpdateTexture(texture, &rect, &frame[static_cast<size_t>(rect.y) * SCREEN_WIDTH + rect.x], SCREEN_WIDTH * sizeof(Uint32));
+            }
+        }
+        fullRedraw = false;
+        previousCommands.swap(commands);
+    }
+    SDL_RenderCopy(renderer, texture, NULL, NULL);
+}
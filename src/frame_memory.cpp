@@ -0,0 +1,132 @@
+#include "frame_memory.h"
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "log.h"
+
+static std::atomic<bool> guardEnabled{false};
+static thread_local bool guardArmed = false;
+
+FrameArena::~FrameArena() {
+    std::free(memory);
+}
+
+bool FrameArena::init(size_t capacity) {
+    std::free(memory);
+    memory = static_cast<unsigned char*>(std::malloc(capacity));
+    this->capacity = memory ? capacity : 0;
+    offset = high = 0;
+    return memory != nullptr;
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    // Align the address, not the offset: malloc only guarantees max_align_t.
+    uintptr_t base = reinterpret_cast<uintptr_t>(memory);
+    size_t start = ((base + offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+    if (start + size > capacity) {
+        ++overflowCount;
+        return nullptr;
+    }
+    offset = start + size;
+    if (offset > high) high = offset;
+    return memory + start;
+}
+
+const char* FrameArena::format(const char* label, int value) {
+    size_t length = std::strlen(label);
+    const size_t digits = 12;
+    char* text = static_cast<char*>(allocate(length + digits, 1));
+    if (!text) return label;
+    std::memcpy(text, label, length);
+    char* end = std::to_chars(text + length, text + length + digits - 1, value).ptr;
+    *end = '\0';
+    return text;
+}
+
+void enableAllocationGuard() {
+    guardEnabled = true;
+}
+
+void AllocationGuard::begin() {
+    if (guardEnabled.load(std::memory_order_relaxed) && ++frames > ALLOC_GUARD_WARMUP_FRAMES) {
+        guardArmed = true;
+    }
+}
+
+void AllocationGuard::end() {
+    guardArmed = false;
+}
+
+static void checkAllocation(size_t size) {
+    if (guardArmed) {
+        guardArmed = false;
+        // The logger neither locks nor allocates, so it is usable from here.
+        // abort() skips atexit, so stop it by hand to get the record out.
+        LOG_ERROR(LOG_CORE, "Heap allocation of {} bytes during a guarded frame", size);
+        logStop();
+        std::abort();
+    }
+}
+
+static void* allocateOrThrow(size_t size) {
+    checkAllocation(size);
+    void* pointer = std::malloc(size ? size : 1);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+static void* allocateAligned(size_t size, size_t alignment) {
+    checkAllocation(size);
+    size = (size + alignment - 1) & ~(alignment - 1);
+#if defined(_WIN32)
+    return _aligned_malloc(size ? size : alignment, alignment);
+#else
+    return std::aligned_alloc(alignment, size ? size : alignment);
+#endif
+}
+
+static void freeAligned(void* pointer) {
+#if defined(_WIN32)
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    checkAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    checkAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    void* pointer = allocateAligned(size, static_cast<size_t>(alignment));
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    void* pointer = allocateAligned(size, static_cast<size_t>(alignment));
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+void operator delete(void* pointer, std::align_val_t) noexcept { freeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { freeAligned(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { freeAligned(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { freeAligned(pointer); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAligned(size, static_cast<size_t>(alignment));
+}
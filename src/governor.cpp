@@ -0,0 +1,87 @@
+#include "governor.h"
+#include <algorithm>
+#include "log.h"
+
+void FrameGovernor::init(double budget) {
+    *this = FrameGovernor();
+    budgetMs = budget;
+}
+
+GovernorDecision FrameGovernor::record(double frameMs) {
+    average = frames == 0 ? frameMs : average + (frameMs - average) * GOVERNOR_SMOOTHING;
+    ++frames;
+    if (budgetMs <= 0) return GOVERNOR_HOLD;
+    // The first frames and those right after a change still carry older
+    // frames in the average, so they count neither way.
+    if (frames - lastChangeFrame < static_cast<unsigned>(GOVERNOR_COOLDOWN_FRAMES)) {
+        overFrames = underFrames = 0;
+        return GOVERNOR_HOLD;
+    }
+    overFrames = average > budgetMs ? overFrames + 1 : 0;
+    underFrames = average < budgetMs * GOVERNOR_HEADROOM ? underFrames + 1 : 0;
+
+    if (overFrames >= GOVERNOR_DOWN_FRAMES && current + 1 < QUALITY_LEVEL_COUNT) {
+        if (lastChange == GOVERNOR_RAISE && frames - lastChangeFrame < static_cast<unsigned>(GOVERNOR_RETRY_FRAMES)) {
+            upFrames = std::min(upFrames * 2, GOVERNOR_MAX_UP_FRAMES);
+        }
+        change(current + 1, GOVERNOR_LOWER);
+        return GOVERNOR_LOWER;
+    }
+    if (underFrames >= upFrames && current > 0) {
+        change(current - 1, GOVERNOR_RAISE);
+        return GOVERNOR_RAISE;
+    }
+    return GOVERNOR_HOLD;
+}
+
+void FrameGovernor::change(int level, GovernorDecision decision) {
+    current = level;
+    lastChange = decision;
+    lastChangeFrame = frames;
+    lastChangeMs = average;
+    overFrames = underFrames = 0;
+    LOG_INFO(LOG_RENDER, "Frame governor {} quality to level {} at {} ms against a {} ms budget",
+             decision == GOVERNOR_LOWER ? "lowered" : "raised", level, average, budgetMs);
+}
+
+bool ScaledTarget::init(SDL_Renderer* target, int w, int h) {
+    renderer = target;
+    width = w;
+    height = h;
+    if (!SDL_RenderTargetSupported(renderer)) {
+        LOG_WARN(LOG_RENDER, "Renderer has no target textures; the scene stays at full resolution");
+        return false;
+    }
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!texture) {
+        LOG_WARN(LOG_RENDER, "Failed to create scene target: {}", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+    SDL_SetTextureScaleMode(texture, SDL_ScaleModeLinear);
+    return true;
+}
+
+void ScaledTarget::shutdown() {
+    if (texture) SDL_DestroyTexture(texture);
+    texture = nullptr;
+}
+
+void ScaledTarget::begin(float scale) {
+    active = texture && scale < 1.0f;
+    if (!active) return;
+    area = {0, 0, std::max(1, static_cast<int>(width * scale)), std::max(1, static_cast<int>(height * scale))};
+    // SDL keeps the window's viewport and scale while a texture is the target
+    // and restores them in end().
+    SDL_SetRenderTarget(renderer, texture);
+    SDL_RenderSetScale(renderer, scale, scale);
+    SDL_Rect viewport = {0, 0, width, height};
+    SDL_RenderSetViewport(renderer, &viewport);
+}
+
+void ScaledTarget::end() {
+    if (!active) return;
+    active = false;
+    SDL_SetRenderTarget(renderer, NULL);
+    SDL_RenderCopy(renderer, texture, &area, NULL);
+}
@@ -0,0 +1,239 @@
+#include "job_system.h"
+#include <SDL2/SDL.h>
+#include <cmath>
+#include <cstdio>
+#include "game.h"
+#include "particles.h"
+
+static thread_local const JobSystem* workerSystem = nullptr;
+static thread_local int workerIndex = 0;
+
+bool JobCounter::done() {
+    if (count.load(std::memory_order_acquire) != 0) return false;
+    // The last job drops the count while holding the lock; taking it here
+    // means that job is finished with the counter before we report done.
+    std::lock_guard<std::mutex> lock(mutex);
+    return true;
+}
+
+void JobSystem::start(int threadCount) {
+    if (!queues.empty()) return;
+    if (threadCount <= 0) {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    stopping = false;
+    for (int i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+        queues.back()->jobs.resize(JOB_QUEUE_CAPACITY);
+    }
+    for (int i = 1; i < threadCount; ++i) {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+void JobSystem::stop() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+    queues.clear();
+    queued = 0;
+}
+
+int JobSystem::currentIndex() const {
+    return workerSystem == this ? workerIndex : 0;
+}
+
+void JobSystem::submit(std::function<void()> function, JobCounter* counter) {
+    if (counter) counter->count.fetch_add(1, std::memory_order_relaxed);
+    Job job;
+    job.function = std::move(function);
+    job.counter = counter;
+    push(std::move(job));
+}
+
+void JobSystem::submitRange(RangeFunction range, void* data, int first, int last, JobCounter* counter) {
+    if (counter) counter->count.fetch_add(1, std::memory_order_relaxed);
+    Job job;
+    job.range = range;
+    job.data = data;
+    job.first = first;
+    job.last = last;
+    job.counter = counter;
+    push(std::move(job));
+}
+
+void JobSystem::submitAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter) {
+    if (counter) counter->count.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (dependency.count.load(std::memory_order_acquire) != 0) {
+            dependency.continuations.emplace_back(std::move(function), counter);
+            return;
+        }
+    }
+    Job job;
+    job.function = std::move(function);
+    job.counter = counter;
+    push(std::move(job));
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    while (!counter.done()) {
+        if (!runOne(currentIndex())) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::push(Job&& job) {
+    bool queuedJob = false;
+    if (!queues.empty()) {
+        Queue& queue = *queues[currentIndex()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tail - queue.head < queue.jobs.size()) {
+            queue.jobs[queue.tail++ % queue.jobs.size()] = std::move(job);
+            queuedJob = true;
+        }
+    }
+    if (!queuedJob) {
+        job.run();
+        finish(job.counter);
+        return;
+    }
+    queued.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+}
+
+bool JobSystem::runOne(int index) {
+    Job job;
+    bool found = false;
+    {
+        Queue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.tail != own.head) {
+            job = std::move(own.jobs[--own.tail % own.jobs.size()]);
+            found = true;
+        }
+    }
+    int count = static_cast<int>(queues.size());
+    for (int i = 1; i < count && !found; ++i) {
+        Queue& victim = *queues[(index + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tail != victim.head) {
+            job = std::move(victim.jobs[victim.head++ % victim.jobs.size()]);
+            found = true;
+        }
+    }
+    if (!found) return false;
+    queued.fetch_sub(1);
+    job.run();
+    finish(job.counter);
+    return true;
+}
+
+void JobSystem::finish(JobCounter* counter) {
+    if (!counter) return;
+    std::vector<std::pair<std::function<void()>, JobCounter*>> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (counter->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ready.swap(counter->continuations);
+        }
+    }
+    for (auto& continuation : ready) {
+        Job job;
+        job.function = std::move(continuation.first);
+        job.counter = continuation.second;
+        push(std::move(job));
+    }
+}
+
+void JobSystem::workerLoop(int index) {
+    workerSystem = this;
+    workerIndex = index;
+    while (true) {
+        if (runOne(index)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [&] { return stopping || queued.load() > 0; });
+        if (stopping) return;
+    }
+}
+
+void JobSystem::runOnMainThread(std::function<void()> job) {
+    std::lock_guard<std::mutex> lock(mainMutex);
+    mainJobs.push_back(std::move(job));
+}
+
+int JobSystem::pumpMainThread(int maxJobs) {
+    int ran = 0;
+    while (ran < maxJobs) {
+        std::function<void()> job;
+        {
+            std::lock_guard<std::mutex> lock(mainMutex);
+            if (mainJobs.empty()) break;
+            job = std::move(mainJobs.front());
+            mainJobs.pop_front();
+        }
+        job();
+        ++ran;
+    }
+    return ran;
+}
+
+static float busyWork(int index) {
+    float value = index * 0.001f;
+    for (int i = 0; i < 64; ++i) {
+        value = value * 0.999f + std::sqrt(value + 1.0f) * 0.001f;
+    }
+    return value;
+}
+
+void runJobBenchmark(int frames) {
+    const int items = 1 << 14;
+    const ParticleEmitter emitter = {0.5f, 2.0f, 100000, 100000, 3.0f, {255, 255, 255, 255}};
+    std::vector<float> results(items);
+    int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    double toMs = 1000.0 / SDL_GetPerformanceFrequency();
+    double computeBase = 0, particleBase = 0;
+
+    std::printf("Job system scaling, %d frames (%d compute items, %d particles)\n", frames, items, MAX_PARTICLES);
+    std::printf("threads  compute ms  speedup  particles ms  speedup\n");
+    for (int threads = 1; threads <= cores; ++threads) {
+        JobSystem jobs;
+        jobs.start(threads);
+        ParticleSystem particles;
+        double compute = 0, particleTime = 0;
+        for (int frame = 0; frame < frames; ++frame) {
+            Uint64 start = SDL_GetPerformanceCounter();
+            jobs.parallelFor(0, items, 256, [&](int first, int last) {
+                for (int i = first; i < last; ++i) {
+                    results[i] = busyWork(i + frame);
+                }
+            });
+            compute += (SDL_GetPerformanceCounter() - start) * toMs;
+
+            particles.emit(emitter, SCREEN_WIDTH / 2.0f, 0.0f, MAX_PARTICLES - particles.count());
+            start = SDL_GetPerformanceCounter();
+            particles.update(&jobs);
+            particleTime += (SDL_GetPerformanceCounter() - start) * toMs;
+        }
+        compute /= frames;
+        particleTime /= frames;
+        if (threads == 1) {
+            computeBase = compute;
+            particleBase = particleTime;
+        }
+        std::printf("%7d  %10.3f  %6.2fx  %12.3f  %6.2fx\n", threads, compute, computeBase / compute, particleTime,
+                    particleBase / particleTime);
+    }
+    std::fflush(stdout);
+}
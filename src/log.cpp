@@ -0,0 +1,296 @@
+#include "log.h"
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+const char* const LEVEL_NAMES[] = {"TRACE", "DEBUG", "INFO", "WARN", "ERROR", "OFF"};
+const char* const SUBSYSTEM_NAMES[LOG_SUBSYSTEM_COUNT] = {"core", "render", "assets", "audio", "sim"};
+const int LOG_IDLE_MS = 5;
+const int LOG_LINE_BYTES = 1024;
+
+static_assert((LOG_RING_CAPACITY & (LOG_RING_CAPACITY - 1)) == 0, "log ring capacity must be a power of two");
+static_assert(LOG_TEXT_BYTES < 256, "textUsed is a byte");
+
+std::atomic<Uint8> logLevels[LOG_SUBSYSTEM_COUNT] = {LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO,
+                                                     LOG_LEVEL_INFO};
+
+// Bounded multi-producer queue after Vyukov: a cell's sequence equals the
+// position that may write it next, and position + 1 once that write is done.
+struct alignas(64) LogCell {
+    std::atomic<size_t> sequence;
+    LogRecord record;
+};
+static_assert(sizeof(LogCell) == 256, "a log cell should fill exactly four cache lines");
+
+struct LogRing {
+    LogRing() {
+        for (size_t i = 0; i < LOG_RING_CAPACITY; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LogCell cells[LOG_RING_CAPACITY];
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+    std::atomic<unsigned> dropped{0};
+};
+
+static LogRing ring;
+static const Uint64 epochTimestamp = logTimestamp();
+static const Uint64 epochCounter = SDL_GetPerformanceCounter();
+static std::thread writer;
+static std::atomic<bool> running{false};
+static std::atomic<bool> discard{false};
+static FILE* output = nullptr;
+
+LogRecord* logBegin() {
+    size_t position = ring.enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+        LogCell& cell = ring.cells[position & (LOG_RING_CAPACITY - 1)];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence == position) {
+            if (ring.enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return &cell.record;
+            }
+        } else if (sequence < position) {
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = ring.enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void logCommit(LogRecord* record) {
+    LogCell* cell = reinterpret_cast<LogCell*>(reinterpret_cast<char*>(record) - offsetof(LogCell, record));
+    size_t position = cell->sequence.load(std::memory_order_relaxed);
+    cell->sequence.store(position + 1, std::memory_order_release);
+}
+
+static int formatArgument(const LogRecord& record, int index, char* out, int room) {
+    int length = 0;
+    switch (record.types[index]) {
+    case LOG_ARG_INT:
+        length = std::snprintf(out, room, "%lld", record.values[index].i);
+        break;
+    case LOG_ARG_UINT:
+        length = std::snprintf(out, room, "%llu", record.values[index].u);
+        break;
+    case LOG_ARG_DOUBLE:
+        length = std::snprintf(out, room, "%g", record.values[index].d);
+        break;
+    case LOG_ARG_STRING:
+        length = record.values[index].u < LOG_TEXT_BYTES
+                     ? std::snprintf(out, room, "%s", record.text + record.values[index].u)
+                     : 0;
+        break;
+    }
+    return std::max(0, std::min(length, room - 1));
+}
+
+// Timestamp ticks per second, measured over everything since startup.
+static double timestampRate() {
+    double seconds = (SDL_GetPerformanceCounter() - epochCounter) / static_cast<double>(SDL_GetPerformanceFrequency());
+    Uint64 ticks = logTimestamp() - epochTimestamp;
+    if (seconds <= 0 || ticks == 0) return static_cast<double>(SDL_GetPerformanceFrequency());
+    return ticks / seconds;
+}
+
+static void writeRecord(const LogRecord& record, double rate) {
+    char line[LOG_LINE_BYTES];
+    const int limit = LOG_LINE_BYTES - 1;
+    double seconds = static_cast<Sint64>(record.time - epochTimestamp) / rate;
+    int used = std::snprintf(line, limit, "[%10.3f] %-5s %-6s ", seconds, LEVEL_NAMES[record.level],
+                             SUBSYSTEM_NAMES[record.subsystem]);
+    used = std::min(used, limit - 1);
+    int argument = 0;
+    for (const char* c = record.format; *c && used < limit; ++c) {
+        if (c[0] == '{' && c[1] == '}' && argument < record.argumentCount) {
+            used += formatArgument(record, argument++, line + used, limit + 1 - used);
+            ++c;
+        } else {
+            line[used++] = *c;
+        }
+    }
+    line[used++] = '\n';
+    std::fwrite(line, 1, used, output);
+}
+
+static bool drain() {
+    bool wrote = false;
+    double rate = timestampRate();
+    while (true) {
+        size_t position = ring.dequeuePos.load(std::memory_order_relaxed);
+        LogCell& cell = ring.cells[position & (LOG_RING_CAPACITY - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != position + 1) break;
+        if (!discard.load(std::memory_order_relaxed)) {
+            writeRecord(cell.record, rate);
+            wrote = true;
+        }
+        cell.sequence.store(position + LOG_RING_CAPACITY, std::memory_order_release);
+        ring.dequeuePos.store(position + 1, std::memory_order_release);
+    }
+    unsigned dropped = ring.dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0 && !discard.load(std::memory_order_relaxed)) {
+        std::fprintf(output, "[%10s] %-5s %-6s %u log records dropped\n", "", LEVEL_NAMES[LOG_LEVEL_WARN],
+                     SUBSYSTEM_NAMES[LOG_CORE], dropped);
+        wrote = true;
+    }
+    if (wrote) std::fflush(output);
+    return wrote;
+}
+
+static void writerLoop() {
+    while (running.load(std::memory_order_acquire)) {
+        if (!drain()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(LOG_IDLE_MS));
+        }
+    }
+    drain();
+}
+
+bool logStart(const std::string& path) {
+    if (running) return true;
+    bool opened = true;
+    output = stderr;
+    if (!path.empty()) {
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (file) {
+            output = file;
+        } else {
+            opened = false;
+        }
+    }
+    running = true;
+    writer = std::thread(writerLoop);
+    static bool registered = false;
+    if (!registered) {
+        std::atexit(logStop);
+        registered = true;
+    }
+    if (!opened) LOG_ERROR(LOG_CORE, "Failed to open log file {}, logging to stderr", path);
+    return opened;
+}
+
+void logStop() {
+    if (!running) return;
+    running = false;
+    writer.join();
+    if (output != stderr) std::fclose(output);
+    output = nullptr;
+}
+
+static int parseLevel(const char* name) {
+    for (int level = LOG_LEVEL_TRACE; level <= LOG_LEVEL_OFF; ++level) {
+        if (SDL_strcasecmp(name, LEVEL_NAMES[level]) == 0) return level;
+    }
+    return -1;
+}
+
+bool logSetLevel(const char* setting) {
+    const char* equals = std::strchr(setting, '=');
+    int level = parseLevel(equals ? equals + 1 : setting);
+    if (level < 0) return false;
+    if (!equals) {
+        for (auto& subsystemLevel : logLevels) {
+            subsystemLevel = static_cast<Uint8>(level);
+        }
+        return true;
+    }
+    std::string name(setting, equals);
+    for (int i = 0; i < LOG_SUBSYSTEM_COUNT; ++i) {
+        if (name == SUBSYSTEM_NAMES[i]) {
+            logLevels[i] = static_cast<Uint8>(level);
+            return true;
+        }
+    }
+    return false;
+}
+
+void logFlush() {
+    if (!running) return;
+    size_t target = ring.enqueuePos.load(std::memory_order_acquire);
+    while (ring.dequeuePos.load(std::memory_order_acquire) < target) {
+        std::this_thread::yield();
+    }
+}
+
+// Every round each producer logs a batch, and together they fit in the ring
+// so no call is dropped. Only the calls are timed; the writer catches up
+// between rounds. The calling thread is producer 0.
+static double logBatch(int thread, int batch) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < batch; ++i) {
+        LOG_INFO(LOG_SIM, "bench thread {} message {} ({})", thread, i, "slice");
+    }
+    return (SDL_GetPerformanceCounter() - start) * 1e9 / SDL_GetPerformanceFrequency();
+}
+
+static double timeBatches(int threads, int rounds) {
+    const int batch = LOG_RING_CAPACITY / 2 / threads;
+    std::vector<double> elapsed(threads, 0.0);
+    std::atomic<int> round{-1};
+    std::atomic<int> finished{0};
+    std::vector<std::thread> producers;
+    for (int t = 1; t < threads; ++t) {
+        producers.emplace_back([&, t] {
+            for (int r = 0; r < rounds; ++r) {
+                while (round.load(std::memory_order_acquire) < r) {
+                    std::this_thread::yield();
+                }
+                elapsed[t] += logBatch(t, batch);
+                finished.fetch_add(1, std::memory_order_release);
+            }
+        });
+    }
+    for (int r = 0; r < rounds; ++r) {
+        round.store(r, std::memory_order_release);
+        elapsed[0] += logBatch(0, batch);
+        while (finished.load(std::memory_order_acquire) < (r + 1) * (threads - 1)) {
+            std::this_thread::yield();
+        }
+        logFlush();
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    double total = 0;
+    for (double time : elapsed) {
+        total += time;
+    }
+    return total / (static_cast<double>(rounds) * batch * threads);
+}
+
+void runLogBenchmark() {
+    const int rounds = 64;
+    const int disabledCalls = 1 << 20;
+    bool started = !running;
+    if (started) logStart("");
+    logFlush();
+    discard = true;
+    Uint8 savedLevels[LOG_SUBSYSTEM_COUNT];
+    for (int i = 0; i < LOG_SUBSYSTEM_COUNT; ++i) {
+        savedLevels[i] = logLevels[i];
+        logLevels[i] = LOG_LEVEL_INFO;
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < disabledCalls; ++i) {
+        LOG_DEBUG(LOG_SIM, "bench disabled {}", i);
+    }
+    double disabled = (SDL_GetPerformanceCounter() - start) * 1e9 / SDL_GetPerformanceFrequency() / disabledCalls;
+    double single = timeBatches(1, rounds);
+    double contended = timeBatches(4, rounds);
+
+    for (int i = 0; i < LOG_SUBSYSTEM_COUNT; ++i) {
+        logLevels[i] = savedLevels[i];
+    }
+    discard = false;
+    if (started) logStop();
+    std::printf("Log call cost (%d byte records, ring of %d)\n", static_cast<int>(sizeof(LogRecord)), LOG_RING_CAPACITY);
+    std::printf("  filtered at runtime: %6.1f ns\n", disabled);
+    std::printf("  1 producer:          %6.1f ns\n", single);
+    std::printf("  4 producers:         %6.1f ns\n", contended);
+    std::fflush(stdout);
+}
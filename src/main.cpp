@@ -9,425 +9,505 @@
 #include <algorithm>
 #include <string>
 #include <cmath>
+#include <cstdio>
+#include "game.h"
+#include "draw.h"
+#include "options.h"
+#include "render_backend.h"
+#include "cpu_raster.h"
+#include "trail_renderer.h"
+#include "job_system.h"
+#include "particles.h"
+#include "ui.h"
+#include "assets.h"
+#include "text.h"
+#include "startup_profile.h"
+#include "sound.h"
+#include "music.h"
+#include "frame_memory.h"
+#include "simulation.h"
+#include "log.h"
+#include "stress.h"
+#include "governor.h"
+
+const char* const STARTUP_BENCH_OUTPUT = "startup_bench.json";
+
+// Only video and the PNG loader are started up front: the menu and game art
+// are PNGs. AssetManager starts the JPEG and WebP decoders when an asset first
+// needs them, and Font initializes SDL_ttf only if a font was not baked.
+bool init(SDL_Window*& window, SDL_Renderer*& renderer, const std::string& rendererName, StartupProfile& profile) {
+    Uint64 start = profile.now();
+    SDL_Init(SDL_INIT_VIDEO);
+    profile.record("SDL_Init", start);
+    start = profile.now();
+    IMG_Init(IMG_INIT_PNG);
+    profile.record("IMG_Init", start);
 
-const int SCREEN_WIDTH = 800;
-const int SCREEN_HEIGHT = 600;
-const int OBJECT_SIZE = 120;
-const int TRAIL_LENGTH = 10;
-const int SPAWN_INTERVAL = 40;
-
-enum ObjectType { FRUIT, BOMB, FRAGMENT };
-
-struct GameObject {
-    int x, y;
-    float speed;
-    int peakHeight;
-    bool rising;
-    ObjectType type;
-    bool sliced;
-    int fragmentDirection;
-
-    GameObject(int startX, int startY, ObjectType objType, int direction = 0) {
-        x = startX;
-        y = startY;
-        speed = (rand() % 4 + 2) * 1.5;
-        peakHeight = SCREEN_HEIGHT - (speed * 40);
-        rising = true;
-        type = objType;
-        sliced = false;
-        fragmentDirection = direction;
+    start = profile.now();
+    window = SDL_CreateWindow("Fruit Slicer", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+    profile.record("SDL_CreateWindow", start);
+    if (!window) {
+        LOG_ERROR(LOG_RENDER, "Failed to create window: {}", SDL_GetError());
+        return false;
     }
+    start = profile.now();
+    renderer = createRenderer(window, rendererName);
+    profile.record("create renderer", start);
+    return renderer != nullptr;
+}
 
-    void update() {
-        if (type == FRAGMENT) {
-            y += speed;
-            x += fragmentDirection * 3;
-        } else {
-            if (rising) {
-                y -= speed;
-                if (y <= peakHeight) {
-                    rising = false;
-                }
-            } else {
-                y += speed;
-            }
-        }
+void close(SDL_Window* window, SDL_Renderer* renderer) {
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    IMG_Quit();
+    if (TTF_WasInit()) {
+        TTF_Quit();
     }
+    SDL_Quit();
+}
 
-    bool isSliced(int prevX, int prevY, int mouseX, int mouseY) {
-        int radius = OBJECT_SIZE / 4;
-        float centerX = x + radius;
-        float centerY = y + radius;
+const size_t FRAME_ARENA_BYTES = 4096;
+const size_t HUD_SPRITE_PIXELS = 256 * 64;
 
-        float dx = mouseX - prevX;
-        float dy = mouseY - prevY;
-        float len = sqrt(dx * dx + dy * dy);
-        if (len < 1) return false;
+void renderText(SDL_Renderer* renderer, Font& font, FrameArena& arena, int score, int hp) {
+    SDL_Color white = {255, 255, 255, 255};
+    font.draw(renderer, arena.format("Score: ", score), 10, 10, white);
+    font.draw(renderer, arena.format("HP: ", hp), 10, 40, white);
+}
 
-        float A = dy;
-        float B = -dx;
-        float C = dx * prevY - dy * prevX;
-        float distance = fabs(A * centerX + B * centerY + C) / len;
-        bool intersects = distance <= radius;
+struct HudText {
+    int value = -1;
+    Sprite sprite;
+};
 
-        float endDx = mouseX - centerX;
-        float endDy = mouseY - centerY;
-        float endDistance = sqrt(endDx * endDx + endDy * endDy);
-        bool closeEnough = endDistance < OBJECT_SIZE;
+void updateHudText(const Font& font, FrameArena& arena, const char* label, int value, HudText& text) {
+    if (text.value == value) return;
+    text.value = value;
+    SDL_Color white = {255, 255, 255, 255};
+    text.sprite.pixels.reserve(HUD_SPRITE_PIXELS);
+    SDL_Surface* surface = font.renderSurface(arena.format(label, value), white);
+    if (surface) {
+        makeSprite(surface, surface->w, surface->h, text.sprite);
+        SDL_FreeSurface(surface);
+    }
+}
 
-        float movementX = mouseX - prevX;
-        float movementY = mouseY - prevY;
-        bool hasMovement = (movementX * movementX + movementY * movementY) > 25;
+const int OVERLAY_LINES = 4;
+const int OVERLAY_PADDING = 8;
+
+// Frame time against the governor's budget, the quality it picked and its last decision.
+void renderProfilerOverlay(SDL_Renderer* renderer, Font& font, const FrameGovernor& governor, double frameMs) {
+    const QualityLevel& quality = governor.quality();
+    char lines[OVERLAY_LINES][96];
+    std::snprintf(lines[0], sizeof(lines[0]), "Frame %.1f ms, avg %.1f / %.1f", frameMs, governor.averageMs(), governor.budget());
+    std::snprintf(lines[1], sizeof(lines[1]), "Quality %d/%d, scale %d%%", governor.level(), QUALITY_LEVEL_COUNT - 1,
+                  static_cast<int>(std::lround(quality.renderScale * 100)));
+    std::snprintf(lines[2], sizeof(lines[2]), "Particles %d%%, trail x%d",
+                  static_cast<int>(std::lround(quality.effectDensity * 100)), quality.trailSubdivisions);
+    if (governor.budget() <= 0) {
+        std::snprintf(lines[3], sizeof(lines[3]), "Governor off");
+    } else if (governor.lastDecision() == GOVERNOR_HOLD) {
+        std::snprintf(lines[3], sizeof(lines[3]), "No change yet");
+    } else {
+        std::snprintf(lines[3], sizeof(lines[3]), "%s at frame %u, %.1f ms",
+                      governor.lastDecision() == GOVERNOR_LOWER ? "Lowered" : "Raised", governor.lastDecisionFrame(),
+                      governor.lastDecisionMs());
+    }
 
-        return intersects && closeEnough && hasMovement;
+    int width = 0, lineHeight = 0;
+    for (const char* line : lines) {
+        int w, h;
+        font.measure(line, w, h);
+        width = std::max(width, w);
+        lineHeight = std::max(lineHeight, h);
     }
-};
+    SDL_Rect panel = {SCREEN_WIDTH - width - 3 * OVERLAY_PADDING, OVERLAY_PADDING, width + 2 * OVERLAY_PADDING,
+                      OVERLAY_LINES * lineHeight + 2 * OVERLAY_PADDING};
+    SDL_BlendMode previous;
+    SDL_GetRenderDrawBlendMode(renderer, &previous);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+    SDL_RenderFillRect(renderer, &panel);
+    SDL_SetRenderDrawBlendMode(renderer, previous);
+    SDL_Color color = {255, 255, 160, 255};
+    for (int i = 0; i < OVERLAY_LINES; ++i) {
+        font.draw(renderer, lines[i], panel.x + OVERLAY_PADDING, panel.y + OVERLAY_PADDING + i * lineHeight, color);
+    }
+}
 
-struct Trail {
-    std::vector<SDL_Point> points;
+// Where the window sits when it is not shaking, and the offset applied now.
+struct WindowShake {
+    int originX = 0, originY = 0;
+    int x = 0, y = 0;
+};
 
-    void addPoint(int x, int y) {
-        points.push_back({x, y});
-        if (points.size() > TRAIL_LENGTH) {
-            points.erase(points.begin());
-        }
+void applyShake(SDL_Window* window, int x, int y, WindowShake& shake) {
+    if (!window || (x == shake.x && y == shake.y)) return;
+    if (shake.x == 0 && shake.y == 0) {
+        SDL_GetWindowPosition(window, &shake.originX, &shake.originY);
     }
-};
+    SDL_SetWindowPosition(window, shake.originX + x, shake.originY + y);
+    shake.x = x;
+    shake.y = y;
+}
 
-bool init(SDL_Window*& window, SDL_Renderer*& renderer, TTF_Font*& font) {
+int runBenchmark(const Options& options) {
     SDL_Init(SDL_INIT_VIDEO);
-    TTF_Init();
     IMG_Init(IMG_INIT_PNG);
-
-    window = SDL_CreateWindow("Fruit Slicer", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    font = TTF_OpenFont("E:/fruitss/novem.ttf", 24);
-    return window && renderer && font;
-}
-
-void close(SDL_Window* window, SDL_Renderer* renderer, TTF_Font* font) {
-    TTF_CloseFont(font);
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
+    AssetManager assets;
+    assets.init(nullptr, options.assetRoot);
+    AssetArchive archive;
+    if (archive.open(assets.resolve(ASSET_ARCHIVE_NAME))) {
+        assets.setArchive(&archive);
+    }
+    {
+        SurfaceHandle background = assets.loadSurface("asset/background.png");
+        SurfaceHandle bomb = assets.loadSurface("asset/bom1.png");
+        runRendererBenchmark(background.get(), bomb.get(), options.benchFrames);
+    }
+    assets.shutdown();
     IMG_Quit();
-    TTF_Quit();
     SDL_Quit();
+    return 0;
 }
 
-void renderText(SDL_Renderer* renderer, TTF_Font* font, int score, int hp) {
-    SDL_Color white = {255, 255, 255, 255};
-    std::string scoreText = "Score: " + std::to_string(score);
-    SDL_Surface* scoreSurface = TTF_RenderText_Solid(font, scoreText.c_str(), white);
-    if (scoreSurface) {
-        SDL_Texture* scoreTexture = SDL_CreateTextureFromSurface(renderer, scoreSurface);
-        if (scoreTexture) {
-            SDL_Rect scoreRect = {10, 10, scoreSurface->w, scoreSurface->h};
-            SDL_RenderCopy(renderer, scoreTexture, NULL, &scoreRect);
-            SDL_DestroyTexture(scoreTexture);
-        }
-        SDL_FreeSurface(scoreSurface);
+int runStress(const Options& options) {
+    SDL_Init(SDL_INIT_VIDEO);
+    IMG_Init(IMG_INIT_PNG);
+    AssetManager assets;
+    assets.init(nullptr, options.assetRoot);
+    AssetArchive archive;
+    if (archive.open(assets.resolve(ASSET_ARCHIVE_NAME))) {
+        assets.setArchive(&archive);
     }
-    std::string hpText = "HP: " + std::to_string(hp);
-    SDL_Surface* hpSurface = TTF_RenderText_Solid(font, hpText.c_str(), white);
-    if (hpSurface) {
-        SDL_Texture* hpTexture = SDL_CreateTextureFromSurface(renderer, hpSurface);
-        if (hpTexture) {
-            SDL_Rect hpRect = {10, 40, hpSurface->w, hpSurface->h};
-            SDL_RenderCopy(renderer, hpTexture, NULL, &hpRect);
-            SDL_DestroyTexture(hpTexture);
-        }
-        SDL_FreeSurface(hpSurface);
+    JobSystem jobs;
+    jobs.start(options.jobThreads);
+    StressConfig config = options.stress;
+    config.frames = options.benchFrames;
+    config.renderer = options.renderer;
+    bool ok;
+    {
+        SurfaceHandle background = assets.loadSurface("asset/background.png");
+        SurfaceHandle bomb = assets.loadSurface("asset/bom1.png");
+        ok = runStressScene(config, background.get(), bomb.get(), jobs);
     }
+    jobs.stop();
+    assets.shutdown();
+    IMG_Quit();
+    SDL_Quit();
+    return ok ? 0 : 1;
 }
 
-void shakeScreen(SDL_Window* window, int intensity, int duration) {
-    if (!window) return;
-    int originalX, originalY;
-    SDL_GetWindowPosition(window, &originalX, &originalY);
-    for (int i = 0; i < duration; ++i) {
-        int offsetX = (rand() % (intensity * 2 + 1)) - intensity;
-        int offsetY = (rand() % (intensity * 2 + 1)) - intensity;
-        SDL_SetWindowPosition(window, originalX + offsetX, originalY + offsetY);
-        SDL_Delay(20);
+int main(int argc, char* argv[]) {
+    StartupProfile startup;
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
     }
-    SDL_SetWindowPosition(window, originalX, originalY);
-}
-
-void drawCircle(SDL_Renderer* renderer, int centerX, int centerY, int radius) {
-    int x = radius;
-    int y = 0;
-    int err = 0;
-    while (x >= y) {
-        SDL_RenderDrawPoint(renderer, centerX + x, centerY + y);
-        SDL_RenderDrawPoint(renderer, centerX + y, centerY + x);
-        SDL_RenderDrawPoint(renderer, centerX - y, centerY + x);
-        SDL_RenderDrawPoint(renderer, centerX - x, centerY + y);
-        SDL_RenderDrawPoint(renderer, centerX - x, centerY - y);
-        SDL_RenderDrawPoint(renderer, centerX - y, centerY - x);
-        SDL_RenderDrawPoint(renderer, centerX + y, centerY - x);
-        SDL_RenderDrawPoint(renderer, centerX + x, centerY - y);
-        if (err <= 0) {
-            y += 1;
-            err += 2 * y + 1;
-        }
-        if (err > 0) {
-            x -= 1;
-            err -= 2 * x + 1;
+    for (const std::string& level : options.logLevels) {
+        if (!logSetLevel(level.c_str())) {
+            std::cout << "Invalid log level: " << level << std::endl;
+            return 1;
         }
     }
-    for (int r = radius - 1; r >= 0; r--) {
-        x = r;
-        y = 0;
-        err = 0;
-        while (x >= y) {
-            SDL_RenderDrawPoint(renderer, centerX + x, centerY + y);
-            SDL_RenderDrawPoint(renderer, centerX + y, centerY + x);
-            SDL_RenderDrawPoint(renderer, centerX - y, centerY + x);
-            SDL_RenderDrawPoint(renderer, centerX - x, centerY + y);
-            SDL_RenderDrawPoint(renderer, centerX - x, centerY - y);
-            SDL_RenderDrawPoint(renderer, centerX - y, centerY - x);
-            SDL_RenderDrawPoint(renderer, centerX + y, centerY - x);
-            SDL_RenderDrawPoint(renderer, centerX + x, centerY - y);
-            if (err <= 0) {
-                y += 1;
-                err += 2 * y + 1;
-            }
-            if (err > 0) {
-                x -= 1;
-                err -= 2 * x + 1;
-            }
-        }
+    logStart(options.logFile);
+    if (options.logBench) {
+        runLogBenchmark();
+        return 0;
     }
-}
-
-void renderMenu(SDL_Renderer* renderer, TTF_Font* font,SDL_Texture* menuTexture, bool& inMenu, bool& quit, int mouseX, int mouseY, bool mouseDown) {
-
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-    SDL_RenderClear(renderer);
-            if (menuTexture) {
-                SDL_RenderCopy(renderer, menuTexture, NULL, NULL);
-            }
-
-    SDL_Color white = {255, 255, 255, 255};
-    SDL_Surface* startSurface = TTF_RenderText_Solid(font, "Start", white);
-    if (startSurface) {
-        int startW = startSurface->w;
-        int startH = startSurface->h;
-        SDL_Rect startRect = {SCREEN_WIDTH / 2 - startW / 2, SCREEN_HEIGHT / 2 - 50, startW, startH};
-        bool startHovered = (mouseX >= startRect.x && mouseX <= startRect.x + startRect.w &&
-                             mouseY >= startRect.y && mouseY <= startRect.y + startRect.h);
-        if (startHovered) {
-            startRect.w = static_cast<int>(startW * 0.9);
-            startRect.h = static_cast<int>(startH * 0.9);
-            startRect.x += (startW - startRect.w) / 2;
-            startRect.y += (startH - startRect.h) / 2;
-            if (mouseDown) {
-                inMenu = false;
-            }
-        }
-        SDL_Texture* startTexture = SDL_CreateTextureFromSurface(renderer, startSurface);
-        if (startTexture) {
-            SDL_RenderCopy(renderer, startTexture, NULL, &startRect);
-            SDL_DestroyTexture(startTexture);
-        }
-        SDL_FreeSurface(startSurface);
+    if (options.listRenderers) {
+        listRenderDrivers();
+        return 0;
     }
-
-    SDL_Surface* exitSurface = TTF_RenderText_Solid(font, "Exit", white);
-    if (exitSurface) {
-        int exitW = exitSurface->w;
-        int exitH = exitSurface->h;
-        SDL_Rect exitRect = {SCREEN_WIDTH / 2 - exitW / 2, SCREEN_HEIGHT / 2 + 50, exitW, exitH};
-        bool exitHovered = (mouseX >= exitRect.x && mouseX <= exitRect.x + exitRect.w &&
-                            mouseY >= exitRect.y && mouseY <= exitRect.y + exitRect.h);
-        if (exitHovered) {
-            exitRect.w = static_cast<int>(exitW * 0.9);
-            exitRect.h = static_cast<int>(exitH * 0.9);
-            exitRect.x += (exitW - exitRect.w) / 2;
-            exitRect.y += (exitH - exitRect.h) / 2;
-            if (mouseDown) {
-                quit = true;
-            }
-        }
-        SDL_Texture* exitTexture = SDL_CreateTextureFromSurface(renderer, exitSurface);
-        if (exitTexture) {
-            SDL_RenderCopy(renderer, exitTexture, NULL, &exitRect);
-            SDL_DestroyTexture(exitTexture);
-        }
-        SDL_FreeSurface(exitSurface);
+    if (options.rendererBench) {
+        return runBenchmark(options);
+    }
+    if (options.stressScene) {
+        return runStress(options);
+    }
+    if (options.particleBench) {
+        runParticleBenchmark(options.benchFrames);
+        return 0;
+    }
+    if (options.jobBench) {
+        runJobBenchmark(options.benchFrames);
+        return 0;
+    }
+    if (options.allocGuard) {
+        enableAllocationGuard();
+    }
+    if (!options.audioDriver.empty()) {
+        SDL_SetHint(SDL_HINT_AUDIODRIVER, options.audioDriver.c_str());
+    }
+    if (options.audioStress) {
+        runAudioStress(options.benchFrames, options.audioBuffer);
+        return 0;
     }
 
-    SDL_RenderPresent(renderer);
-}
-
-int main() {
-    srand(time(0));
     SDL_Window* window = nullptr;
     SDL_Renderer* renderer = nullptr;
-    TTF_Font* font = nullptr;
-    SDL_Texture* backgroundTexture = nullptr;
-    SDL_Texture* menuTexture = nullptr;
 
-    if (!init(window, renderer, font)) {
+    if (!init(window, renderer, options.renderer, startup)) {
         return -1;
     }
 
-    
-    SDL_Surface* backgroundSurface = IMG_Load("E:/fruitss/asset/background.png");
-    if (backgroundSurface) {
-        backgroundTexture = SDL_CreateTextureFromSurface(renderer, backgroundSurface);
-        SDL_FreeSurface(backgroundSurface);
+    Uint64 stepStart = startup.now();
+    JobSystem jobs;
+    jobs.start(options.jobThreads);
+    startup.record("start job threads", stepStart);
+    AssetManager assets;
+    assets.init(renderer, options.assetRoot);
+    assets.setStartupProfile(&startup);
+    assets.setJobSystem(&jobs);
+    stepStart = startup.now();
+    AssetArchive archive;
+    if (archive.open(assets.resolve(ASSET_ARCHIVE_NAME))) {
+        assets.setArchive(&archive);
     }
-    SDL_Surface* menuSurface = IMG_Load("E:/fruitss/asset/menu.PNG");
-    if (menuSurface) {
-        menuTexture = SDL_CreateTextureFromSurface(renderer, menuSurface);
-        SDL_FreeSurface(menuSurface);
-    } else {
-        std::cout << "Failed to load menu image: " << IMG_GetError() << std::endl;
+    startup.record("open asset archive", stepStart);
+    stepStart = startup.now();
+    TextureCache textureCache;
+    if (options.textureCache && textureCache.init(renderer)) {
+        assets.setTextureCache(&textureCache);
+    }
+    startup.record("texture cache init", stepStart);
+    assets.setTextureBudget(static_cast<size_t>(options.textureBudgetMb) * 1024 * 1024);
+    CpuRasterizer cpuRaster;
+    bool cpuRender = options.cpuRender;
+    // The menu only needs its own art; game textures are requested when a game starts.
+    TextureHandle menuHandle = assets.requestTexture("asset/menu.PNG");
+    TextureHandle backgroundHandle;
+    TextureHandle bomHandle;
+    bool gameLoaded = false;
+    if (!runLoadingScreen(renderer, assets, &startup)) {
+        assets.shutdown();
+        close(window, renderer);
+        return 0;
+    }
+    stepStart = startup.now();
+    Font font;
+    if (!font.open(assets, "novem.ttf", 24, options.bakedFonts)) {
+        assets.shutdown();
+        close(window, renderer);
+        return -1;
     }
-    SDL_Texture* bomTexture = IMG_LoadTexture(renderer, "E:/fruitss/asset/bom1.png");
+    startup.record(font.isBaked() ? "open baked font" : "TTF_Init + open font", stepStart);
+
+    Sprite bomSprite;
+    SoundSystem sound;
+    MusicPlayer music;
+    bool audioStarted = false;
+    Menu menu;
+    menu.init(renderer, font, menuHandle);
+    menuHandle.reset();
+    HudText scoreText;
+    HudText hpText;
     bool quit = false;
     bool inMenu = true;
-    bool gameOver = false;
     SDL_Event e;
-    std::vector<GameObject> objects;
-    std::vector<GameObject> newObjects;
-    int spawnTimer = 0;
-    Trail trail;
-    int score = 0;
-    int hp = 5;
-    bool mouseDown = false;
-    int mouseX = 0, mouseY = 0, prevMouseX = 0, prevMouseY = 0;
+    Simulation simulation;
+    SnapshotStats snapshotStats;
+    FrameArena frameArena;
+    frameArena.init(FRAME_ARENA_BYTES);
+    AllocationGuard allocationGuard;
+    WindowShake windowShake;
+    TrailRenderer trailRenderer;
+    ParticleRenderer particleRenderer;
+    FrameGovernor governor;
+    governor.init(options.frameBudgetMs);
+    ScaledTarget sceneTarget;
+    bool showProfiler = options.profiler;
+    double frameMs = 0;
+    const double counterMs = 1000.0 / SDL_GetPerformanceFrequency();
 
     while (!quit) {
-        while (SDL_PollEvent(&e)) {
-            if (e.type == SDL_QUIT) {
-                quit = true;
-            } else if (e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_LEFT) {
-                mouseDown = true;
-                SDL_GetMouseState(&mouseX, &mouseY);
-                if (!inMenu) {
-                    prevMouseX = mouseX;
-                    prevMouseY = mouseY;
+        if (inMenu) {
+            stepStart = startup.now();
+            menu.render();
+            assets.endFrame();
+            if (options.startupBench) {
+                startup.record("first menu frame", stepStart);
+                startup.print();
+                if (startup.writeJson(STARTUP_BENCH_OUTPUT)) {
+                    std::cout << "Wrote " << STARTUP_BENCH_OUTPUT << std::endl;
                 }
-            } else if (e.type == SDL_MOUSEBUTTONUP && e.button.button == SDL_BUTTON_LEFT) {
-                mouseDown = false;
-            } else if (gameOver && e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_r) {
-                objects.clear();
-                newObjects.clear();
-                score = 0;
-                hp = 5;
-                spawnTimer = SPAWN_INTERVAL;
-                trail.points.clear();
-                mouseDown = false;
-                gameOver = false;
-                objects.push_back(GameObject(rand() % (SCREEN_WIDTH - OBJECT_SIZE), SCREEN_HEIGHT, FRUIT));
-                if (rand() % 3 == 0) {
-                    objects.push_back(GameObject(rand() % (SCREEN_WIDTH - OBJECT_SIZE), SCREEN_HEIGHT, BOMB));
+                break;
+            }
+            // Audio comes up after the first menu frame so it never delays it.
+            if (!audioStarted) {
+                audioStarted = true;
+                if (options.audio && sound.init(options.audioBuffer) && music.init(assets)) {
+                    music.play(MENU_TRACK);
                 }
             }
+            if (SDL_WaitEventTimeout(&e, MENU_IDLE_TIMEOUT)) {
+                do {
+                    MenuAction action = menu.handleEvent(e);
+                    if (e.type == SDL_QUIT || action == MENU_EXIT) {
+                        quit = true;
+                    } else if (action == MENU_START) {
+                        inMenu = false;
+                    }
+                } while (SDL_PollEvent(&e));
+            }
+            continue;
         }
 
-        SDL_GetMouseState(&mouseX, &mouseY);
-
-        if (inMenu) {
-            renderMenu(renderer, font, menuTexture, inMenu, quit, mouseX, mouseY, mouseDown);
-        } else if (!gameOver) {
-            // Loại bỏ currentMouseX và currentMouseY, sử dụng trực tiếp mouseX và mouseY
-            if (mouseDown) {
-                trail.addPoint(mouseX, mouseY);
+        if (!gameLoaded) {
+            gameLoaded = true;
+            SurfaceHandle backgroundSurface;
+            SurfaceHandle bomSurface;
+            if (cpuRender) {
+                backgroundSurface = assets.requestSurface("asset/background.png");
+                bomSurface = assets.requestSurface("asset/bom1.png");
+            } else {
+                backgroundHandle = assets.requestTexture("asset/background.png");
+                bomHandle = assets.requestTexture("asset/bom1.png");
             }
-
-            if (++spawnTimer >= SPAWN_INTERVAL) {
-                spawnTimer = 0;
-                objects.push_back(GameObject(rand() % (SCREEN_WIDTH - OBJECT_SIZE), SCREEN_HEIGHT, FRUIT));
-                if (rand() % 3 == 0) {
-                    objects.push_back(GameObject(rand() % (SCREEN_WIDTH - OBJECT_SIZE), SCREEN_HEIGHT, BOMB));
+            if (!runLoadingScreen(renderer, assets)) {
+                break;
+            }
+            if (cpuRender) {
+                cpuRender = cpuRaster.init(renderer, backgroundSurface.get(), &jobs, options.dirtyRects);
+                if (bomSurface) {
+                    makeSprite(bomSurface.get(), bomSurface.get()->w / 2, bomSurface.get()->h / 2, bomSprite);
                 }
+                if (!cpuRender) {
+                    backgroundHandle = assets.loadTexture("asset/background.png");
+                    bomHandle = assets.loadTexture("asset/bom1.png");
+                }
+            }
+            if (!cpuRender) {
+                sceneTarget.init(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
             }
+            simulation.start(jobs, sound, music);
+        }
+
+        Uint64 frameStart = SDL_GetPerformanceCounter();
 
-            newObjects.clear();
-            for (auto& obj : objects) {
-                if (mouseDown && obj.isSliced(prevMouseX, prevMouseY, mouseX, mouseY) && !obj.sliced) {
+        while (SDL_PollEvent(&e)) {
+            if (e.type == SDL_QUIT) {
+                quit = true;
+            } else if (e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_LEFT) {
+                simulation.post({INPUT_MOUSE_DOWN, e.button.x, e.button.y});
+            } else if (e.type == SDL_MOUSEBUTTONUP && e.button.button == SDL_BUTTON_LEFT) {
+                simulation.post({INPUT_MOUSE_UP, e.button.x, e.button.y});
+            } else if (e.type == SDL_MOUSEMOTION) {
+                simulation.post({INPUT_MOUSE_MOVE, e.motion.x, e.motion.y});
+            } else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_r) {
+                simulation.post({INPUT_RESTART, 0, 0});
+            } else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F3) {
+                showProfiler = !showProfiler;
+            }
+        }
+
+        allocationGuard.begin();
+        frameArena.reset();
+        bool fresh = simulation.acquire();
+        const FrameSnapshot& frame = simulation.current();
+        applyShake(window, frame.shakeX, frame.shakeY, windowShake);
+        const QualityLevel& quality = governor.quality();
+        int trailSubdivisions = options.smoothTrail ? quality.trailSubdivisions : 1;
+        // Fetch both every frame, game over included, so the scene's textures
+        // stay most recently used. An evicted one is null until it reloads.
+        SDL_Texture* backgroundTexture = backgroundHandle.get();
+        SDL_Texture* bomTexture = bomHandle.get();
+
+        if (!frame.gameOver) {
+            if (cpuRender) {
+                cpuRaster.beginFrame();
+                for (auto& obj : frame.objects) {
                     if (obj.type == BOMB) {
-                        shakeScreen(window, 10, 10);
-                        hp--;
-                        obj.sliced = true;
-                        if (hp <= 0) {
-                            gameOver = true;
+                        if (obj.x >= 0 && obj.x < SCREEN_WIDTH && obj.y >= 0 && obj.y < SCREEN_HEIGHT) {
+                            cpuRaster.addSprite(&bomSprite, obj.x, obj.y);
                         }
                         continue;
-                    } else if (obj.type == FRUIT) {
-                        obj.sliced = true;
-                        score += 10;
-                        int radius = OBJECT_SIZE / 4;
-                        newObjects.push_back(GameObject(obj.x, obj.y, FRAGMENT, -1));
-                        newObjects.push_back(GameObject(obj.x + radius, obj.y, FRAGMENT, 1));
-                        continue;
                     }
+                    Uint32 color = obj.type == FRUIT ? 0xFFFF0000 : 0xFFFFA500;
+                    cpuRaster.addDisc(obj.x + DISC_RADIUS, obj.y + DISC_RADIUS, color);
                 }
-                obj.update();
-                if (!(obj.type == FRAGMENT && obj.y > SCREEN_HEIGHT)) {
-                    newObjects.push_back(obj);
+                updateHudText(font, frameArena, "Score: ", frame.score, scoreText);
+                updateHudText(font, frameArena, "HP: ", frame.hp, hpText);
+                cpuRaster.addSprite(&scoreText.sprite, 10, 10);
+                cpuRaster.addSprite(&hpText.sprite, 10, 40);
+                cpuRaster.endFrame();
+                particleRenderer.render(renderer, frame.particles);
+                trailRenderer.render(renderer, frame.trail, trailSubdivisions);
+            } else {
+                sceneTarget.begin(quality.renderScale);
+                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+                SDL_RenderClear(renderer);
+                if (backgroundTexture) {
+                    SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL);
                 }
-            }
-            objects = newObjects;
 
-            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-            SDL_RenderClear(renderer);
-            if (backgroundTexture) {
-                SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL);
-            }
-
-            for (auto& obj : objects) {
-                if (obj.type == FRUIT) SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-                else if (obj.type == BOMB) {
-                    if (bomTexture) {
-                        int texWidth, texHeight;
-                        SDL_QueryTexture(bomTexture, NULL, NULL, &texWidth, &texHeight);
-                        SDL_Rect bomRect = {obj.x, obj.y, texWidth/2, texHeight/2};
+                for (auto& obj : frame.objects) {
+                    if (obj.type == FRUIT) SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+                    else if (obj.type == BOMB) {
+                        if (bomTexture) {
+                            int texWidth, texHeight;
+                            SDL_QueryTexture(bomTexture, NULL, NULL, &texWidth, &texHeight);
+                            SDL_Rect bomRect = {obj.x, obj.y, texWidth/2, texHeight/2};
             
-                        if (bomRect.x >= 0 && bomRect.x < SCREEN_WIDTH &&
-                            bomRect.y >= 0 && bomRect.y < SCREEN_HEIGHT) {
-                            SDL_RenderCopy(renderer, bomTexture, NULL, &bomRect);
+                            if (bomRect.x >= 0 && bomRect.x < SCREEN_WIDTH &&
+                                bomRect.y >= 0 && bomRect.y < SCREEN_HEIGHT) {
+                                SDL_RenderCopy(renderer, bomTexture, NULL, &bomRect);
+                            }
                         }
+                        continue;
                     }
-                    continue;
+                    else if (obj.type == FRAGMENT) SDL_SetRenderDrawColor(renderer, 255, 165, 0, 255);
+                    drawCircle(renderer, obj.x + OBJECT_SIZE / 4, obj.y + OBJECT_SIZE / 4, OBJECT_SIZE / 4);
                 }
-                else if (obj.type == FRAGMENT) SDL_SetRenderDrawColor(renderer, 255, 165, 0, 255);
-                drawCircle(renderer, obj.x + OBJECT_SIZE / 4, obj.y + OBJECT_SIZE / 4, OBJECT_SIZE / 4);
+                particleRenderer.render(renderer, frame.particles);
+                trailRenderer.render(renderer, frame.trail, trailSubdivisions);
+                sceneTarget.end();
+                renderText(renderer, font, frameArena, frame.score, frame.hp);
             }
-            renderText(renderer, font, score, hp);
         }
     
 
-        if (gameOver && !inMenu) {
+        if (frame.gameOver) {
             SDL_Color red = {255, 0, 0, 255};
-            SDL_Surface* surface = TTF_RenderText_Solid(font, "Game Over! Press R to Restart", red);
-            if (surface) {
-                SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-                if (texture) {
-                    SDL_Rect textRect = {SCREEN_WIDTH / 2 - surface->w / 2, SCREEN_HEIGHT / 2 - surface->h / 2, surface->w, surface->h};
-                    SDL_RenderCopy(renderer, texture, NULL, &textRect);
-                    SDL_DestroyTexture(texture);
-                }
-                SDL_FreeSurface(surface);
-            }
+            const char* message = "Game Over! Press R to Restart";
+            int w, h;
+            font.measure(message, w, h);
+            font.draw(renderer, message, SCREEN_WIDTH / 2 - w / 2, SCREEN_HEIGHT / 2 - h / 2, red);
         }
 
-        if (!inMenu) {
-            SDL_RenderPresent(renderer);
+        if (showProfiler) {
+            renderProfilerOverlay(renderer, font, governor, frameMs);
         }
-        SDL_Delay(16);
 
-        if (!gameOver && !inMenu) {
-            prevMouseX = mouseX;
-            prevMouseY = mouseY;
-            SDL_GetMouseState(&mouseX, &mouseY);
+        SDL_RenderPresent(renderer);
+        frameMs = (SDL_GetPerformanceCounter() - frameStart) * counterMs;
+        if (governor.record(frameMs) != GOVERNOR_HOLD) {
+            simulation.setEffectDensity(governor.quality().effectDensity);
         }
+        snapshotStats.record(frame, fresh);
+        assets.endFrame();
+        allocationGuard.end();
+        // Reloads of evicted textures start and finish here, outside the guarded frame.
+        assets.pump(LOADING_BATCH);
+        SDL_Delay(16);
     }
 
-    SDL_DestroyTexture(backgroundTexture);
-    close(window, renderer, font);
+    simulation.stop();
+    if (options.frameStats) {
+        snapshotStats.print();
+    }
+    if (cpuRender) {
+        cpuRaster.shutdown();
+    }
+    sceneTarget.shutdown();
+    music.shutdown();
+    sound.shutdown();
+    menu.shutdown();
+    font.close();
+    if (options.assetReport) {
+        assets.report();
+    }
+    assets.shutdown();
+    close(window, renderer);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,277 @@
+#define OV_EXCLUDE_STATIC_CALLBACKS
+#include "music.h"
+#include <SDL2/SDL_mixer.h>
+#include <vorbis/vorbisfile.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "log.h"
+
+const int MUSIC_MIX_BLOCK = 256;
+
+static size_t readSource(void* buffer, size_t size, size_t count, void* source) {
+    return SDL_RWread(static_cast<SDL_RWops*>(source), buffer, size, count);
+}
+
+static int seekSource(void* source, ogg_int64_t offset, int whence) {
+    return SDL_RWseek(static_cast<SDL_RWops*>(source), offset, whence) < 0 ? -1 : 0;
+}
+
+static int closeSource(void* source) {
+    return SDL_RWclose(static_cast<SDL_RWops*>(source));
+}
+
+static long tellSource(void* source) {
+    return static_cast<long>(SDL_RWtell(static_cast<SDL_RWops*>(source)));
+}
+
+bool MusicPlayer::init(AssetManager& assets) {
+    Uint16 format;
+    if (!Mix_QuerySpec(&frequency, &format, &outputChannels) || format != AUDIO_S16SYS) {
+        LOG_WARN(LOG_AUDIO, "Music disabled: audio device is not open");
+        return false;
+    }
+    this->assets = &assets;
+    for (Deck& deck : decks) {
+        deck.ring.init(MUSIC_RING_FRAMES * 2);
+    }
+    target = -1;
+    wake = SDL_CreateSemaphore(0);
+    running = true;
+    thread = std::thread(&MusicPlayer::run, this);
+    Mix_HookMusic(hook, this);
+    return true;
+}
+
+void MusicPlayer::shutdown() {
+    if (!running) return;
+    // Mix_HookMusic takes the audio lock, so the callback is not running once it returns.
+    Mix_HookMusic(nullptr, nullptr);
+    running = false;
+    SDL_SemPost(wake);
+    thread.join();
+    SDL_DestroySemaphore(wake);
+    wake = nullptr;
+    for (Deck& deck : decks) {
+        closeDeck(deck);
+        deck.fade = 0;
+        deck.audible = false;
+    }
+}
+
+void MusicPlayer::play(const std::string& track, int fadeMs) {
+    if (!running) return;
+    MusicCommand command = {};
+    SDL_strlcpy(command.track, track.c_str(), sizeof(command.track));
+    command.fadeMs = fadeMs;
+    if (commands.push(command)) {
+        SDL_SemPost(wake);
+    }
+}
+
+void MusicPlayer::hook(void* userdata, Uint8* stream, int length) {
+    MusicPlayer* player = static_cast<MusicPlayer*>(userdata);
+    player->mix(reinterpret_cast<Sint16*>(stream), length / static_cast<int>(sizeof(Sint16) * player->outputChannels));
+}
+
+// Audio thread. A deck is read while it is the target or still fading out;
+// audible tells the decoder when it may reuse a deck.
+void MusicPlayer::mix(Sint16* out, int frames) {
+    const float halfPi = 1.57079633f;
+    int current = target.load(std::memory_order_acquire);
+    float step = 1.0f / fadeFrames.load(std::memory_order_relaxed);
+    float block[MUSIC_MIX_BLOCK * 2];
+    float sum[MUSIC_MIX_BLOCK * 2];
+
+    for (int done = 0; done < frames; done += MUSIC_MIX_BLOCK) {
+        int count = std::min(MUSIC_MIX_BLOCK, frames - done);
+        std::memset(sum, 0, sizeof(float) * count * 2);
+        for (int d = 0; d < 2; ++d) {
+            Deck& deck = decks[d];
+            float goal = d == current ? 1.0f : 0.0f;
+            if (goal == 0 && deck.fade <= 0) continue;
+            deck.audible.store(true, std::memory_order_relaxed);
+
+            size_t got = deck.ring.read(block, count * 2);
+            if (got < static_cast<size_t>(count) * 2) {
+                std::memset(block + got, 0, sizeof(float) * (count * 2 - got));
+                if (d == current) ++underrunCount;
+            }
+            for (int i = 0; i < count; ++i) {
+                if (deck.fade != goal) {
+                    deck.fade = goal > deck.fade ? std::min(goal, deck.fade + step) : std::max(goal, deck.fade - step);
+                }
+                // Equal-power curve so the crossfade does not dip in the middle.
+                float gain = std::sin(deck.fade * halfPi) * MUSIC_VOLUME;
+                sum[i * 2] += block[i * 2] * gain;
+                sum[i * 2 + 1] += block[i * 2 + 1] * gain;
+            }
+        }
+
+        Sint16* dst = out + static_cast<size_t>(done) * outputChannels;
+        for (int i = 0; i < count; ++i) {
+            float left = std::clamp(sum[i * 2], -1.0f, 1.0f) * 32767.0f;
+            float right = std::clamp(sum[i * 2 + 1], -1.0f, 1.0f) * 32767.0f;
+            if (outputChannels == 1) {
+                dst[i] = static_cast<Sint16>((left + right) * 0.5f);
+                continue;
+            }
+            Sint16* frame = dst + i * outputChannels;
+            frame[0] = static_cast<Sint16>(left);
+            frame[1] = static_cast<Sint16>(right);
+            for (int c = 2; c < outputChannels; ++c) {
+                frame[c] = 0;
+            }
+        }
+    }
+
+    for (int d = 0; d < 2; ++d) {
+        if (d != current && decks[d].fade <= 0) {
+            decks[d].audible.store(false, std::memory_order_release);
+        }
+    }
+}
+
+bool MusicPlayer::openDeck(Deck& deck, const std::string& track) {
+    SDL_RWops* source = assets->openStream(track);
+    if (!source) {
+        LOG_WARN(LOG_AUDIO, "Music track {} not found; playing without it", track);
+        return false;
+    }
+    deck.file = new OggVorbis_File;
+    ov_callbacks callbacks = {readSource, seekSource, closeSource, tellSource};
+    if (ov_open_callbacks(source, deck.file, nullptr, 0, callbacks) != 0) {
+        LOG_ERROR(LOG_AUDIO, "Failed to open Ogg Vorbis stream {}", track);
+        SDL_RWclose(source);
+        delete deck.file;
+        deck.file = nullptr;
+        return false;
+    }
+    vorbis_info* info = ov_info(deck.file, -1);
+    deck.channels = info->channels;
+    deck.step = static_cast<double>(info->rate) / frequency;
+    deck.position = 0;
+    deck.previous[0] = deck.previous[1] = 0;
+    deck.resampled.resize((static_cast<size_t>(MUSIC_DECODE_FRAMES / deck.step) + 2) * 2);
+    deck.ring.reset();
+    deck.track = track;
+
+    // Fill the ring before the deck becomes audible. Bounded by the ring's
+    // size in blocks, since fill() also reports progress on stream holes.
+    size_t blocks = deck.ring.space() / deck.resampled.size() + 1;
+    for (size_t i = 0; i < blocks && fill(deck); ++i) {
+    }
+    if (deck.ring.available() == 0) {
+        LOG_ERROR(LOG_AUDIO, "Music track {} has no samples", track);
+        closeDeck(deck);
+        return false;
+    }
+    return true;
+}
+
+void MusicPlayer::closeDeck(Deck& deck) {
+    if (!deck.file) return;
+    ov_clear(deck.file);
+    delete deck.file;
+    deck.file = nullptr;
+    deck.track.clear();
+}
+
+// Decodes one block into the deck's ring if there is room for it. Returns
+// whether anything was decoded.
+bool MusicPlayer::fill(Deck& deck) {
+    if (deck.ring.space() < deck.resampled.size()) return false;
+
+    float** pcm;
+    int bitstream;
+    long frames = ov_read_float(deck.file, &pcm, MUSIC_DECODE_FRAMES, &bitstream);
+    if (frames == 0) {
+        // End of stream: seeking back to the first sample keeps the loop
+        // gapless. A stream that is still empty after that has no samples.
+        if (ov_pcm_seek(deck.file, 0) != 0) return false;
+        frames = ov_read_float(deck.file, &pcm, MUSIC_DECODE_FRAMES, &bitstream);
+    }
+    if (frames <= 0) {
+        return frames == OV_HOLE;
+    }
+    deck.channels = ov_info(deck.file, -1)->channels;
+    const float* left = pcm[0];
+    const float* right = deck.channels > 1 ? pcm[1] : pcm[0];
+
+    size_t produced = 0;
+    if (deck.step == 1.0) {
+        for (long i = 0; i < frames; ++i) {
+            deck.resampled[produced++] = left[i];
+            deck.resampled[produced++] = right[i];
+        }
+    } else {
+        // Linear interpolation; index -1 is the last frame of the previous block.
+        while (produced + 2 <= deck.resampled.size()) {
+            long index = static_cast<long>(std::floor(deck.position));
+            if (index + 1 >= frames) break;
+            float t = static_cast<float>(deck.position - index);
+            float l0 = index < 0 ? deck.previous[0] : left[index];
+            float r0 = index < 0 ? deck.previous[1] : right[index];
+            deck.resampled[produced++] = l0 + (left[index + 1] - l0) * t;
+            deck.resampled[produced++] = r0 + (right[index + 1] - r0) * t;
+            deck.position += deck.step;
+        }
+        deck.position -= frames;
+        deck.previous[0] = left[frames - 1];
+        deck.previous[1] = right[frames - 1];
+    }
+    deck.ring.write(deck.resampled.data(), produced);
+    return true;
+}
+
+void MusicPlayer::run() {
+    MusicCommand pending;
+    bool hasPending = false;
+    while (running) {
+        if (!hasPending) {
+            hasPending = commands.pop(pending);
+        }
+        if (hasPending) {
+            int current = target.load(std::memory_order_relaxed);
+            std::string track = pending.track;
+            int fade = std::max(1, pending.fadeMs * frequency / 1000);
+            if ((current >= 0 && decks[current].track == track) ||
+                std::find(unplayable.begin(), unplayable.end(), track) != unplayable.end()) {
+                hasPending = false;
+            } else if (track.empty()) {
+                fadeFrames.store(fade, std::memory_order_relaxed);
+                target.store(-1, std::memory_order_release);
+                hasPending = false;
+            } else {
+                // Wait for a deck that has finished fading out.
+                for (int d = 0; d < 2; ++d) {
+                    if (d == current || decks[d].audible.load(std::memory_order_acquire)) continue;
+                    closeDeck(decks[d]);
+                    if (openDeck(decks[d], track)) {
+                        fadeFrames.store(fade, std::memory_order_relaxed);
+                        target.store(d, std::memory_order_release);
+                    } else {
+                        unplayable.push_back(track);
+                    }
+                    hasPending = false;
+                    break;
+                }
+            }
+        }
+
+        int current = target.load(std::memory_order_relaxed);
+        bool decoded = false;
+        for (int d = 0; d < 2; ++d) {
+            Deck& deck = decks[d];
+            if (!deck.file) continue;
+            if (d == current || deck.audible.load(std::memory_order_acquire)) {
+                decoded = fill(deck) || decoded;
+            } else {
+                closeDeck(deck);
+            }
+        }
+        if (!decoded) {
+            SDL_SemWaitTimeout(wake, 5);
+        }
+    }
+}
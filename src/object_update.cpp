@@ -0,0 +1,101 @@
+#include "object_update.h"
+#include <algorithm>
+#include "log.h"
+
+// Each chunk's output arrays start on their own cache line, so jobs writing
+// neighbouring chunks never share one.
+const size_t CHUNK_ALIGNMENT = 64;
+
+size_t ObjectUpdater::scratchBytes(int count) {
+    size_t chunks = (count + OBJECT_CHUNK - 1) / OBJECT_CHUNK + 1;
+    return chunks * (sizeof(Chunk) + 2 * CHUNK_ALIGNMENT) + static_cast<size_t>(count) * (sizeof(GameObject) + sizeof(GameEvent)) +
+           CHUNK_ALIGNMENT;
+}
+
+// Cuts or moves one object. Returns whether it stays in play; event is set to
+// what happened to it, or EVENT_TYPE_COUNT if nothing did, at its final position.
+static bool advance(GameObject& object, const Blade& blade, int floor, GameEventType& event) {
+    event = EVENT_TYPE_COUNT;
+    if (blade.active && object.type != FRAGMENT && !object.sliced &&
+        object.isSliced(blade.prevX, blade.prevY, blade.x, blade.y)) {
+        event = object.type == BOMB ? EVENT_BOMB_HIT : EVENT_SLICE;
+        return false;
+    }
+    object.update();
+    if (!object.isGone(floor)) return true;
+    if (object.type == FRUIT) event = EVENT_FRUIT_MISSED;
+    return false;
+}
+
+void ObjectUpdater::updateChunk(const std::vector<GameObject>& objects, const Blade& blade, Chunk& chunk, int index) {
+    chunk.survivorCount = 0;
+    chunk.eventCount = 0;
+    int end = std::min(static_cast<int>(objects.size()), (index + 1) * OBJECT_CHUNK);
+    for (int i = index * OBJECT_CHUNK; i < end; ++i) {
+        GameObject object = objects[i];
+        GameEventType event;
+        if (advance(object, blade, floor, event)) {
+            new (&chunk.survivors[chunk.survivorCount++]) GameObject(object);
+        }
+        if (event != EVENT_TYPE_COUNT) {
+            new (&chunk.events[chunk.eventCount++]) GameEvent{event, object.x, object.y};
+        }
+    }
+}
+
+void ObjectUpdater::updateInPlace(std::vector<GameObject>& objects, const Blade& blade, GameEventBuffer& events) {
+    size_t kept = 0;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        GameObject object = objects[i];
+        GameEventType event;
+        if (advance(object, blade, floor, event)) {
+            objects[kept++] = object;
+        }
+        if (event != EVENT_TYPE_COUNT) {
+            events.push(event, object.x, object.y);
+        }
+    }
+    objects.erase(objects.begin() + kept, objects.end());
+}
+
+void ObjectUpdater::update(std::vector<GameObject>& objects, const Blade& blade, JobSystem* jobs, FrameArena& arena,
+                           GameEventBuffer& events) {
+    int count = static_cast<int>(objects.size());
+    int chunkCount = (count + OBJECT_CHUNK - 1) / OBJECT_CHUNK;
+    Chunk* chunks = arena.allocate<Chunk>(chunkCount);
+    for (int index = 0; chunks && index < chunkCount; ++index) {
+        int size = std::min(OBJECT_CHUNK, count - index * OBJECT_CHUNK);
+        chunks[index].survivors = static_cast<GameObject*>(arena.allocate(sizeof(GameObject) * size, CHUNK_ALIGNMENT));
+        chunks[index].events = static_cast<GameEvent*>(arena.allocate(sizeof(GameEvent) * size, CHUNK_ALIGNMENT));
+        if (!chunks[index].survivors || !chunks[index].events) chunks = nullptr;
+    }
+    if (!chunks) {
+        if (!scratchWarned) {
+            scratchWarned = true;
+            LOG_ERROR(LOG_SIM, "Frame arena is smaller than scratchBytes({}); updating objects serially", count);
+        }
+        updateInPlace(objects, blade, events);
+        return;
+    }
+
+    auto updateChunks = [&](int first, int last) {
+        for (int index = first; index < last; ++index) {
+            updateChunk(objects, blade, chunks[index], index);
+        }
+    };
+    if (jobs) {
+        jobs->parallelFor(0, chunkCount, 1, updateChunks);
+    } else {
+        updateChunks(0, chunkCount);
+    }
+
+    merged.clear();
+    for (int index = 0; index < chunkCount; ++index) {
+        const Chunk& chunk = chunks[index];
+        merged.insert(merged.end(), chunk.survivors, chunk.survivors + chunk.survivorCount);
+        for (int i = 0; i < chunk.eventCount; ++i) {
+            events.push(chunk.events[i].type, chunk.events[i].x, chunk.events[i].y);
+        }
+    }
+    objects.swap(merged);
+}
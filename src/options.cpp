@@ -0,0 +1,150 @@
+#include "options.h"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+
+static void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --renderer <name>     render driver to use (software, opengl, opengles2, direct3d, ...)\n"
+              << "  --renderer list       print the render drivers SDL can use and exit\n"
+              << "  --renderer-bench      run the benchmark scene on every render driver and exit\n"
+              << "  --particle-bench      time the particle update with 50k live particles and exit\n"
+              << "  --job-bench           time parallel jobs on 1 to N threads and exit\n"
+              << "  --bench-frames <n>    frames per benchmark (default 300)\n"
+              << "  --cpu-render          composite frames on the CPU into a streaming texture\n"
+              << "  --job-threads <n>     threads running jobs, counting the main thread (default: one per core)\n"
+              << "  --dirty-rects         with --cpu-render, only redraw regions that changed\n"
+              << "  --no-trail-smoothing  draw the blade trail without Catmull-Rom smoothing\n"
+              << "  --frame-stats         print how old the simulation snapshot was at each present on exit\n"
+              << "  --frame-budget <ms>   drop resolution, particles and trail detail while frames take longer\n"
+              << "                        than this (0 = never, default 12)\n"
+              << "  --profiler            show the profiler overlay from the start (F3 toggles it)\n"
+              << "  --alloc-guard         abort if a game frame allocates from the heap after warmup\n"
+              << "  --asset-root <dir>    load assets from <dir> instead of the executable's directory\n"
+              << "  --asset-report        print load time and resident size of every asset at exit\n"
+              << "  --no-texture-cache    always decode images instead of using the pre-converted cache\n"
+              << "  --texture-budget <MB> evict least recently used textures above this size (0 = unlimited, default 16)\n"
+              << "  --no-baked-fonts      render text through SDL_ttf even when a baked font exists\n"
+              << "  --startup-bench       time each startup step up to the first menu frame, write startup_bench.json and exit\n"
+              << "  --no-audio            run without sound\n"
+              << "  --audio-buffer <n>    audio buffer size in sample frames (default 512; smaller is lower latency)\n"
+              << "  --audio-driver <name> audio driver to use (dummy, or disk to write the mix to sdlaudio.raw)\n"
+              << "  --audio-stress        fire hundreds of slice sounds per second for --bench-frames frames and\n"
+              << "                        report mixer time per callback (use with --audio-driver on headless machines)\n"
+              << "  --stress              sweep 10 to 1M live objects with a scripted blade, write update, slice and\n"
+              << "                        render times per entity count to stress.csv and exit\n"
+              << "  --stress-size <WxH>   stress playfield and window size (default 800x600)\n"
+              << "  --stress-max <n>      largest entity count in the sweep (default 1000000)\n"
+              << "  --stress-mix <f,b,g>  relative shares of fruit, bombs and fragments (default 60,20,20)\n"
+              << "  --stress-spawn <n>    objects respawned per frame to refill the population (default: all)\n"
+              << "  --stress-csv <path>   where to write the stress curves\n"
+              << "  --stress-no-render    time only the simulation stages\n"
+              << "  --log-file <path>     write the log to <path> instead of stderr\n"
+              << "  --log-level <level>   trace, debug, info, warn, error or off; <subsystem>=<level> sets one of\n"
+              << "                        core, render, assets, audio, sim (repeatable, default info)\n"
+              << "  --log-bench           time a log call with one and four threads logging and exit\n"
+              << "  --help                show this message" << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--renderer") == 0 && hasValue) {
+            options.renderer = argv[++i];
+            if (options.renderer == "list") {
+                options.listRenderers = true;
+                options.renderer.clear();
+            }
+        } else if (strcmp(arg, "--renderer-bench") == 0) {
+            options.rendererBench = true;
+        } else if (strcmp(arg, "--particle-bench") == 0) {
+            options.particleBench = true;
+        } else if (strcmp(arg, "--job-bench") == 0) {
+            options.jobBench = true;
+        } else if (strcmp(arg, "--bench-frames") == 0 && hasValue) {
+            options.benchFrames = atoi(argv[++i]);
+            if (options.benchFrames < 1) options.benchFrames = 1;
+        } else if (strcmp(arg, "--cpu-render") == 0) {
+            options.cpuRender = true;
+        } else if (strcmp(arg, "--job-threads") == 0 && hasValue) {
+            options.jobThreads = atoi(argv[++i]);
+        } else if (strcmp(arg, "--dirty-rects") == 0) {
+            options.cpuRender = true;
+            options.dirtyRects = true;
+        } else if (strcmp(arg, "--frame-stats") == 0) {
+            options.frameStats = true;
+        } else if (strcmp(arg, "--frame-budget") == 0 && hasValue) {
+            options.frameBudgetMs = std::max(0.0, atof(argv[++i]));
+        } else if (strcmp(arg, "--profiler") == 0) {
+            options.profiler = true;
+        } else if (strcmp(arg, "--alloc-guard") == 0) {
+            options.allocGuard = true;
+        } else if (strcmp(arg, "--no-trail-smoothing") == 0) {
+            options.smoothTrail = false;
+        } else if (strcmp(arg, "--asset-root") == 0 && hasValue) {
+            options.assetRoot = argv[++i];
+        } else if (strcmp(arg, "--asset-report") == 0) {
+            options.assetReport = true;
+        } else if (strcmp(arg, "--no-texture-cache") == 0) {
+            options.textureCache = false;
+        } else if (strcmp(arg, "--texture-budget") == 0 && hasValue) {
+            options.textureBudgetMb = atoi(argv[++i]);
+            if (options.textureBudgetMb < 0) options.textureBudgetMb = 0;
+        } else if (strcmp(arg, "--no-baked-fonts") == 0) {
+            options.bakedFonts = false;
+        } else if (strcmp(arg, "--startup-bench") == 0) {
+            options.startupBench = true;
+        } else if (strcmp(arg, "--no-audio") == 0) {
+            options.audio = false;
+        } else if (strcmp(arg, "--audio-buffer") == 0 && hasValue) {
+            options.audioBuffer = atoi(argv[++i]);
+            if (options.audioBuffer < 64) options.audioBuffer = 64;
+        } else if (strcmp(arg, "--audio-driver") == 0 && hasValue) {
+            options.audioDriver = argv[++i];
+        } else if (strcmp(arg, "--audio-stress") == 0) {
+            options.audioStress = true;
+        } else if (strcmp(arg, "--stress") == 0) {
+            options.stressScene = true;
+        } else if (strcmp(arg, "--stress-size") == 0 && hasValue) {
+            StressConfig& stress = options.stress;
+            if (sscanf(argv[++i], "%dx%d", &stress.width, &stress.height) != 2 || stress.width < OBJECT_SIZE * 2 ||
+                stress.height < OBJECT_SIZE * 2) {
+                std::cout << "Invalid stress size: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (strcmp(arg, "--stress-max") == 0 && hasValue) {
+            options.stress.maxEntities = std::max(STRESS_MIN_ENTITIES, atoi(argv[++i]));
+        } else if (strcmp(arg, "--stress-mix") == 0 && hasValue) {
+            StressConfig& stress = options.stress;
+            if (sscanf(argv[++i], "%d,%d,%d", &stress.fruitShare, &stress.bombShare, &stress.fragmentShare) != 3 ||
+                stress.fruitShare < 0 || stress.bombShare < 0 || stress.fragmentShare < 0 ||
+                stress.fruitShare + stress.bombShare + stress.fragmentShare == 0) {
+                std::cout << "Invalid stress mix: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (strcmp(arg, "--stress-spawn") == 0 && hasValue) {
+            options.stress.spawnRate = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(arg, "--stress-csv") == 0 && hasValue) {
+            options.stress.csvPath = argv[++i];
+        } else if (strcmp(arg, "--stress-no-render") == 0) {
+            options.stress.render = false;
+        } else if (strcmp(arg, "--log-file") == 0 && hasValue) {
+            options.logFile = argv[++i];
+        } else if (strcmp(arg, "--log-level") == 0 && hasValue) {
+            options.logLevels.push_back(argv[++i]);
+        } else if (strcmp(arg, "--log-bench") == 0) {
+            options.logBench = true;
+        } else if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return false;
+        } else {
+            std::cout << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
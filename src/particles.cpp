@@ -0,0 +1,158 @@
+#include "particles.h"
+#include "game.h"
+#include "job_system.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+ParticleSystem::ParticleSystem()
+    : x(MAX_PARTICLES), y(MAX_PARTICLES), vx(MAX_PARTICLES), vy(MAX_PARTICLES),
+      life(MAX_PARTICLES), fade(MAX_PARTICLES), size(MAX_PARTICLES), color(MAX_PARTICLES) {}
+
+ParticleRenderer::ParticleRenderer() : xy(MAX_PARTICLES * 8), vertexColors(MAX_PARTICLES * 4), indices(MAX_PARTICLES * 6) {
+    for (int i = 0; i < MAX_PARTICLES; ++i) {
+        int v = 4 * i;
+        int* quad = &indices[6 * i];
+        quad[0] = v;
+        quad[1] = v + 1;
+        quad[2] = v + 2;
+        quad[3] = v;
+        quad[4] = v + 2;
+        quad[5] = v + 3;
+    }
+}
+
+float ParticleSystem::random01() {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (seed >> 8) * (1.0f / 16777216.0f);
+}
+
+int ParticleSystem::emit(const ParticleEmitter& emitter, float originX, float originY, int amount) {
+    amount = std::min(amount, MAX_PARTICLES - live);
+    for (int n = 0; n < amount; ++n) {
+        int i = live++;
+        float angle = random01() * 6.2831853f;
+        float speed = emitter.speedMin + (emitter.speedMax - emitter.speedMin) * random01();
+        int lifetime = emitter.lifeMin + static_cast<int>((emitter.lifeMax - emitter.lifeMin) * random01());
+        x[i] = originX;
+        y[i] = originY;
+        vx[i] = std::cos(angle) * speed;
+        vy[i] = std::sin(angle) * speed;
+        life[i] = 1.0f;
+        fade[i] = 1.0f / std::max(lifetime, 1);
+        size[i] = emitter.size * (0.5f + random01());
+        color[i] = emitter.color;
+    }
+    return amount;
+}
+
+void ParticleSystem::integrate(int first, int last) {
+    int i = first;
+#if defined(__SSE2__)
+    const __m128 gravity = _mm_set1_ps(PARTICLE_GRAVITY);
+    for (; i + 4 <= last; i += 4) {
+        __m128 pvx = _mm_loadu_ps(&vx[i]);
+        __m128 pvy = _mm_add_ps(_mm_loadu_ps(&vy[i]), gravity);
+        _mm_storeu_ps(&vy[i], pvy);
+        _mm_storeu_ps(&x[i], _mm_add_ps(_mm_loadu_ps(&x[i]), pvx));
+        _mm_storeu_ps(&y[i], _mm_add_ps(_mm_loadu_ps(&y[i]), pvy));
+        _mm_storeu_ps(&life[i], _mm_sub_ps(_mm_loadu_ps(&life[i]), _mm_loadu_ps(&fade[i])));
+    }
+#endif
+    for (; i < last; ++i) {
+        vy[i] += PARTICLE_GRAVITY;
+        x[i] += vx[i];
+        y[i] += vy[i];
+        life[i] -= fade[i];
+    }
+}
+
+void ParticleSystem::update(JobSystem* jobs) {
+    if (jobs) {
+        jobs->parallelFor(0, live, PARTICLE_JOB_GRAIN, [this](int first, int last) { integrate(first, last); });
+    } else {
+        integrate(0, live);
+    }
+
+    for (int i = 0; i < live;) {
+        if (life[i] > 0.0f && y[i] < SCREEN_HEIGHT) {
+            ++i;
+            continue;
+        }
+        int last = --live;
+        x[i] = x[last];
+        y[i] = y[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        life[i] = life[last];
+        fade[i] = fade[last];
+        size[i] = size[last];
+        color[i] = color[last];
+    }
+}
+
+void ParticleSystem::snapshot(ParticleFrame& frame) const {
+    frame.x.assign(x.begin(), x.begin() + live);
+    frame.y.assign(y.begin(), y.begin() + live);
+    frame.size.assign(size.begin(), size.begin() + live);
+    frame.color.resize(live);
+    for (int i = 0; i < live; ++i) {
+        SDL_Color c = color[i];
+        c.a = static_cast<Uint8>(c.a * life[i]);
+        frame.color[i] = c;
+    }
+    frame.count = live;
+}
+
+void ParticleRenderer::render(SDL_Renderer* renderer, const ParticleFrame& frame) {
+    int live = frame.count;
+    if (live == 0) return;
+    for (int i = 0; i < live; ++i) {
+        float half = frame.size[i] * 0.5f;
+        float* quad = &xy[8 * i];
+        quad[0] = frame.x[i] - half;
+        quad[1] = frame.y[i] - half;
+        quad[2] = frame.x[i] + half;
+        quad[3] = frame.y[i] - half;
+        quad[4] = frame.x[i] + half;
+        quad[5] = frame.y[i] + half;
+        quad[6] = frame.x[i] - half;
+        quad[7] = frame.y[i] + half;
+        SDL_Color c = frame.color[i];
+        SDL_Color* colors = &vertexColors[4 * i];
+        colors[0] = c;
+        colors[1] = c;
+        colors[2] = c;
+        colors[3] = c;
+    }
+    SDL_BlendMode previous;
+    SDL_GetRenderDrawBlendMode(renderer, &previous);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_RenderGeometryRaw(renderer, NULL, xy.data(), 2 * sizeof(float), vertexColors.data(), sizeof(SDL_Color),
+                          NULL, 0, 4 * live, indices.data(), 6 * live, sizeof(int));
+    SDL_SetRenderDrawBlendMode(renderer, previous);
+}
+
+void runParticleBenchmark(int frames) {
+    const int target = 50000;
+    const ParticleEmitter emitter = {0.5f, 2.0f, 100000, 100000, 3.0f, {255, 255, 255, 255}};
+    ParticleSystem particles;
+    double toMs = 1000.0 / SDL_GetPerformanceFrequency();
+    double total = 0, worst = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+        // Keep the pool topped up; particles falling off screen are recycled.
+        particles.emit(emitter, SCREEN_WIDTH / 2.0f, 0.0f, target - particles.count());
+        Uint64 start = SDL_GetPerformanceCounter();
+        particles.update();
+        double ms = (SDL_GetPerformanceCounter() - start) * toMs;
+        total += ms;
+        worst = std::max(worst, ms);
+    }
+    std::cout << "Particle update, " << target << " particles: avg " << total / frames << " ms, max " << worst
+              << " ms over " << frames << " frames" << std::endl;
+}
@@ -0,0 +1,157 @@
+#include "render_backend.h"
+#include "game.h"
+#include "draw.h"
+#include "log.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+const int BENCH_OBJECTS = 200;
+
+void listRenderDrivers() {
+    int count = SDL_GetNumRenderDrivers();
+    for (int i = 0; i < count; ++i) {
+        SDL_RendererInfo info;
+        if (SDL_GetRenderDriverInfo(i, &info) != 0) continue;
+        std::cout << i << ": " << info.name
+                  << ((info.flags & SDL_RENDERER_ACCELERATED) ? " (accelerated)" : "")
+                  << ((info.flags & SDL_RENDERER_SOFTWARE) ? " (software)" : "")
+                  << ((info.flags & SDL_RENDERER_TARGETTEXTURE) ? " (target texture)" : "")
+                  << std::endl;
+    }
+}
+
+int findRenderDriver(const std::string& name) {
+    int count = SDL_GetNumRenderDrivers();
+    for (int i = 0; i < count; ++i) {
+        SDL_RendererInfo info;
+        if (SDL_GetRenderDriverInfo(i, &info) == 0 && name == info.name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+SDL_Renderer* createRenderer(SDL_Window* window, const std::string& name) {
+    SDL_Renderer* renderer = nullptr;
+    if (!name.empty()) {
+        int index = findRenderDriver(name);
+        if (index >= 0) {
+            renderer = SDL_CreateRenderer(window, index, 0);
+            if (!renderer) {
+                LOG_ERROR(LOG_RENDER, "Renderer '{}' failed: {}", name, SDL_GetError());
+            }
+        } else {
+            LOG_ERROR(LOG_RENDER, "Renderer '{}' is not available. Available renderers:", name);
+            logFlush();
+            listRenderDrivers();
+        }
+    }
+    if (!renderer) {
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    }
+    if (!renderer) {
+        LOG_WARN(LOG_RENDER, "No accelerated renderer ({}), falling back to software", SDL_GetError());
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+    }
+    if (renderer) {
+        SDL_RendererInfo info;
+        if (SDL_GetRendererInfo(renderer, &info) == 0) {
+            LOG_INFO(LOG_RENDER, "Using renderer: {}", info.name);
+        }
+    }
+    return renderer;
+}
+
+static void renderBenchScene(SDL_Renderer* renderer, SDL_Texture* backgroundTexture, SDL_Texture* bomTexture,
+                             std::vector<GameObject>& objects, Random& random) {
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    if (backgroundTexture) {
+        SDL_RenderCopy(renderer, backgroundTexture, NULL, NULL);
+    }
+    int texWidth = 0, texHeight = 0;
+    if (bomTexture) {
+        SDL_QueryTexture(bomTexture, NULL, NULL, &texWidth, &texHeight);
+    }
+    for (auto& obj : objects) {
+        obj.update();
+        // Replace whatever leaves so every frame draws the same number of objects.
+        if (obj.isGone()) {
+            int y = obj.type == FRAGMENT ? 0 : SCREEN_HEIGHT;
+            obj = GameObject(random.below(SCREEN_WIDTH - OBJECT_SIZE), y, obj.type, random, obj.fragmentDirection);
+        }
+        if (obj.type == BOMB) {
+            if (bomTexture) {
+                SDL_Rect bomRect = {obj.x, obj.y, texWidth / 2, texHeight / 2};
+                SDL_RenderCopy(renderer, bomTexture, NULL, &bomRect);
+            }
+            continue;
+        }
+        if (obj.type == FRUIT) SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+        else SDL_SetRenderDrawColor(renderer, 255, 165, 0, 255);
+        drawCircle(renderer, obj.x + OBJECT_SIZE / 4, obj.y + OBJECT_SIZE / 4, OBJECT_SIZE / 4);
+    }
+    SDL_RenderPresent(renderer);
+}
+
+static void benchmarkDriver(int index, const char* name, SDL_Surface* background, SDL_Surface* bomb, int frames) {
+    SDL_Window* window = SDL_CreateWindow("Fruit Slicer - renderer benchmark", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                          SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+    if (!window) {
+        LOG_ERROR(LOG_RENDER, "{}: window creation failed: {}", name, SDL_GetError());
+        return;
+    }
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, index, 0);
+    if (!renderer) {
+        LOG_ERROR(LOG_RENDER, "{}: renderer creation failed: {}", name, SDL_GetError());
+        SDL_DestroyWindow(window);
+        return;
+    }
+    SDL_Texture* backgroundTexture = background ? SDL_CreateTextureFromSurface(renderer, background) : nullptr;
+    SDL_Texture* bomTexture = bomb ? SDL_CreateTextureFromSurface(renderer, bomb) : nullptr;
+
+    // Same seed for every backend so each one draws the identical scene.
+    Random random;
+    random.seed(1234);
+    std::vector<GameObject> objects;
+    for (int i = 0; i < BENCH_OBJECTS; ++i) {
+        ObjectType type = (i % 10 == 0) ? BOMB : (i % 3 == 0 ? FRAGMENT : FRUIT);
+        int x = random.below(SCREEN_WIDTH - OBJECT_SIZE);
+        int y = random.below(SCREEN_HEIGHT);
+        objects.push_back(GameObject(x, y, type, random, (i % 2) ? 1 : -1));
+    }
+
+    std::vector<double> frameMs;
+    frameMs.reserve(frames);
+    double toMs = 1000.0 / SDL_GetPerformanceFrequency();
+    for (int frame = 0; frame < frames; ++frame) {
+        SDL_PumpEvents();
+        Uint64 start = SDL_GetPerformanceCounter();
+        renderBenchScene(renderer, backgroundTexture, bomTexture, objects, random);
+        frameMs.push_back((SDL_GetPerformanceCounter() - start) * toMs);
+    }
+
+    std::sort(frameMs.begin(), frameMs.end());
+    double total = 0;
+    for (double ms : frameMs) total += ms;
+    double avg = total / frameMs.size();
+    std::cout << name << ": avg " << avg << " ms, min " << frameMs.front()
+              << " ms, p95 " << frameMs[frameMs.size() * 95 / 100]
+              << " ms, max " << frameMs.back() << " ms (" << (avg > 0 ? 1000.0 / avg : 0) << " fps)" << std::endl;
+
+    SDL_DestroyTexture(bomTexture);
+    SDL_DestroyTexture(backgroundTexture);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+}
+
+void runRendererBenchmark(SDL_Surface* background, SDL_Surface* bomb, int frames) {
+    std::cout << "Renderer benchmark: " << BENCH_OBJECTS << " objects, " << frames << " frames per backend" << std::endl;
+    int count = SDL_GetNumRenderDrivers();
+    for (int i = 0; i < count; ++i) {
+        SDL_RendererInfo info;
+        if (SDL_GetRenderDriverInfo(i, &info) != 0) continue;
+        benchmarkDriver(i, info.name, background, bomb, frames);
+    }
+}
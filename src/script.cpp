@@ -0,0 +1,81 @@
+#include "script.h"
+#include <algorithm>
+#include <new>
+#include "log.h"
+
+alignas(std::max_align_t) static unsigned char framePool[MAX_SCRIPTS][SCRIPT_FRAME_BYTES];
+static void* freeFrames[MAX_SCRIPTS];
+static int freeFrameCount = -1;
+
+void* Script::promise_type::operator new(size_t size) {
+    if (freeFrameCount < 0) {
+        for (int i = 0; i < MAX_SCRIPTS; ++i) {
+            freeFrames[i] = framePool[MAX_SCRIPTS - 1 - i];
+        }
+        freeFrameCount = MAX_SCRIPTS;
+    }
+    if (size <= SCRIPT_FRAME_BYTES && freeFrameCount > 0) {
+        return freeFrames[--freeFrameCount];
+    }
+    LOG_WARN(LOG_SIM, "Script frame of {} bytes does not fit the script pool", size);
+    return ::operator new(size);
+}
+
+void Script::promise_type::operator delete(void* frame, size_t size) {
+    unsigned char* bytes = static_cast<unsigned char*>(frame);
+    if (bytes >= &framePool[0][0] && bytes < &framePool[0][0] + sizeof(framePool)) {
+        freeFrames[freeFrameCount++] = frame;
+    } else {
+        ::operator delete(frame, size);
+    }
+}
+
+void TickAwaiter::await_suspend(Script::Handle handle) {
+    ScriptScheduler* scheduler = handle.promise().scheduler;
+    if (!scheduler->wheel.schedule(count, &ScriptScheduler::resume, handle.address())) {
+        LOG_ERROR(LOG_SIM, "Timer wheel is full; a script will not resume");
+    }
+}
+
+void ScriptScheduler::init(int timerCapacity) {
+    wheel.init(timerCapacity + MAX_SCRIPTS);
+    scripts.reserve(MAX_SCRIPTS);
+}
+
+bool ScriptScheduler::start(Script script) {
+    if (!script.handle || scripts.size() >= static_cast<size_t>(MAX_SCRIPTS)) return false;
+    Script::Handle handle = script.handle;
+    script.handle = nullptr;
+    handle.promise().scheduler = this;
+    scripts.push_back(handle);
+    run(handle);
+    return true;
+}
+
+void ScriptScheduler::resume(void* address) {
+    Script::Handle handle = Script::Handle::from_address(address);
+    handle.promise().scheduler->run(handle);
+}
+
+void ScriptScheduler::run(Script::Handle handle) {
+    handle.resume();
+    if (!handle.done()) return;
+    auto found = std::find(scripts.begin(), scripts.end(), handle);
+    if (found != scripts.end()) {
+        *found = scripts.back();
+        scripts.pop_back();
+    }
+    handle.destroy();
+}
+
+void ScriptScheduler::tick() {
+    wheel.advance();
+}
+
+void ScriptScheduler::clear() {
+    wheel.clear();
+    for (Script::Handle handle : scripts) {
+        handle.destroy();
+    }
+    scripts.clear();
+}
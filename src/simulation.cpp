@@ -0,0 +1,268 @@
+#include "simulation.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include "log.h"
+
+void Simulation::start(JobSystem& jobs, SoundSystem& sound, MusicPlayer& music) {
+    if (thread.joinable()) return;
+    this->jobs = &jobs;
+    this->sound = &sound;
+    this->music = &music;
+    objects.reserve(MAX_OBJECTS);
+    objectUpdater.reserve(MAX_OBJECTS);
+    // At most one event per object, plus game over.
+    events.reserve(MAX_OBJECTS + 1);
+    scripts.init(0);
+    arena.init(ObjectUpdater::scratchBytes(MAX_OBJECTS));
+    random.seed(static_cast<Uint32>(SDL_GetPerformanceCounter() ^ time(nullptr)));
+    running = true;
+    thread = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void Simulation::post(const InputEvent& event) {
+    input.push(event);
+}
+
+void Simulation::run() {
+    music->play(GAME_TRACK);
+    reset();
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    const Uint64 stepTicks = frequency * SIMULATION_STEP_MS / 1000;
+    Uint64 next = SDL_GetPerformanceCounter();
+    while (running) {
+        allocationGuard.begin();
+        arena.reset();
+        step();
+        publish();
+        allocationGuard.end();
+        next += stepTicks;
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now < next) {
+            SDL_Delay(static_cast<Uint32>((next - now) * 1000 / frequency));
+        } else if (now - next > stepTicks * 4) {
+            // Too far behind to catch up; drop the backlog instead of bursting.
+            next = now;
+        }
+    }
+}
+
+void Simulation::reset() {
+    scripts.clear();
+    objects.clear();
+    score = 0;
+    hp = START_HP;
+    shakeX = shakeY = 0;
+    shakeTicksLeft = 0;
+    shaking = false;
+    trail.clear();
+    particles.clear();
+    mouseDown = false;
+    gameOver = false;
+    fruitSliced = fruitMissed = bombsHit = 0;
+    scripts.start(rampDifficulty());
+    scripts.start(spawnWaves());
+}
+
+void Simulation::spawn() {
+    if (objects.size() + 2 > static_cast<size_t>(MAX_OBJECTS)) return;
+    objects.push_back(GameObject(random.below(SCREEN_WIDTH - OBJECT_SIZE), SCREEN_HEIGHT, FRUIT, random));
+    if (random.below(3) == 0) {
+        objects.push_back(GameObject(random.below(SCREEN_WIDTH - OBJECT_SIZE), SCREEN_HEIGHT, BOMB, random));
+    }
+}
+
+void Simulation::step() {
+    InputEvent event;
+    while (input.pop(event)) {
+        switch (event.type) {
+        case INPUT_MOUSE_DOWN:
+            mouseDown = true;
+            mouseX = prevMouseX = event.x;
+            mouseY = prevMouseY = event.y;
+            break;
+        case INPUT_MOUSE_UP:
+            mouseDown = false;
+            break;
+        case INPUT_MOUSE_MOVE:
+            mouseX = event.x;
+            mouseY = event.y;
+            break;
+        case INPUT_RESTART:
+            if (gameOver) {
+                reset();
+                music->play(GAME_TRACK);
+            }
+            break;
+        }
+    }
+    // Scripts keep running after game over so effects can finish.
+    scripts.tick();
+    if (gameOver) return;
+
+    if (mouseDown) {
+        trail.addPoint(mouseX, mouseY);
+    } else {
+        trail.fade();
+    }
+
+    Blade blade = {mouseDown, prevMouseX, prevMouseY, mouseX, mouseY};
+    events.clear();
+    objectUpdater.update(objects, blade, jobs, arena, events);
+
+    // Scoring decides game over, so it runs first; particles then update on a
+    // job while this thread spawns fragments and queues sounds.
+    applyScoring();
+    JobCounter effects;
+    jobs->submit([this] { applyEffects(); }, &effects);
+    spawnFragments();
+    playEventSounds();
+    recordStats();
+    jobs->wait(effects);
+
+    if (!gameOver) {
+        prevMouseX = mouseX;
+        prevMouseY = mouseY;
+    }
+}
+
+void Simulation::applyScoring() {
+    score += 10 * events.count(EVENT_SLICE);
+    int hits = events.count(EVENT_BOMB_HIT);
+    if (hits == 0) return;
+    // A hit during a shake restarts the running one rather than starting a
+    // second script that would zero the offset under it.
+    shakeIntensity = SHAKE_INTENSITY;
+    shakeTicksLeft = SHAKE_TICKS;
+    if (!shaking) {
+        shaking = true;
+        scripts.start(shake());
+    }
+    hp -= hits;
+    if (hp <= 0 && !gameOver) {
+        gameOver = true;
+        events.push(EVENT_GAME_OVER, 0, 0);
+    }
+}
+
+void Simulation::applyEffects() {
+    const int radius = OBJECT_SIZE / 4;
+    float density = effectDensity.load(std::memory_order_relaxed);
+    int juice = std::max(1, static_cast<int>(40 * density));
+    int blast = std::max(1, static_cast<int>(200 * density));
+    for (const GameEvent& event : events.all()) {
+        if (event.type == EVENT_SLICE) {
+            particles.emit(JUICE_EMITTER, event.x + radius, event.y + radius, juice);
+        } else if (event.type == EVENT_BOMB_HIT) {
+            particles.emit(BLAST_EMITTER, event.x + radius, event.y + radius, blast);
+        }
+    }
+    particles.update(jobs);
+}
+
+void Simulation::spawnFragments() {
+    const int radius = OBJECT_SIZE / 4;
+    for (const GameEvent& event : events.all()) {
+        if (event.type != EVENT_SLICE) continue;
+        if (objects.size() + 2 > static_cast<size_t>(MAX_OBJECTS)) return;
+        objects.push_back(GameObject(event.x, event.y, FRAGMENT, random, -1));
+        objects.push_back(GameObject(event.x + radius, event.y, FRAGMENT, random, 1));
+    }
+}
+
+void Simulation::playEventSounds() {
+    const int radius = OBJECT_SIZE / 4;
+    for (const GameEvent& event : events.all()) {
+        switch (event.type) {
+        case EVENT_SLICE:
+            sound->play(SOUND_SLICE, panForX(event.x + radius, SCREEN_WIDTH));
+            break;
+        case EVENT_BOMB_HIT:
+            sound->play(SOUND_BOMB, panForX(event.x + radius, SCREEN_WIDTH));
+            break;
+        case EVENT_GAME_OVER:
+            sound->play(SOUND_GAME_OVER);
+            music->play(MENU_TRACK);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void Simulation::recordStats() {
+    fruitSliced += events.count(EVENT_SLICE);
+    fruitMissed += events.count(EVENT_FRUIT_MISSED);
+    bombsHit += events.count(EVENT_BOMB_HIT);
+    if (events.count(EVENT_GAME_OVER) > 0) {
+        LOG_INFO(LOG_SIM, "Game over: score {}, {} fruit sliced, {} missed, {} bombs hit", score, fruitSliced,
+                 fruitMissed, bombsHit);
+    }
+}
+
+Script Simulation::spawnWaves() {
+    while (true) {
+        if (!gameOver) spawn();
+        co_await ticks(spawnInterval);
+    }
+}
+
+Script Simulation::rampDifficulty() {
+    spawnInterval = SPAWN_INTERVAL;
+    while (spawnInterval > MIN_SPAWN_INTERVAL) {
+        co_await ticks(DIFFICULTY_STEP_TICKS);
+        spawnInterval = std::max(MIN_SPAWN_INTERVAL, spawnInterval - SPAWN_INTERVAL_STEP);
+    }
+}
+
+Script Simulation::shake() {
+    while (shakeTicksLeft > 0) {
+        --shakeTicksLeft;
+        shakeX = random.below(shakeIntensity * 2 + 1) - shakeIntensity;
+        shakeY = random.below(shakeIntensity * 2 + 1) - shakeIntensity;
+        co_await ticks(1);
+    }
+    shakeX = shakeY = 0;
+    shaking = false;
+}
+
+void Simulation::publish() {
+    FrameSnapshot& frame = snapshots.back();
+    frame.objects.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        frame.objects[i] = {objects[i].x, objects[i].y, objects[i].type};
+    }
+    frame.trail = trail;
+    particles.snapshot(frame.particles);
+    frame.score = score;
+    frame.hp = hp;
+    frame.gameOver = gameOver;
+    frame.shakeX = shakeX;
+    frame.shakeY = shakeY;
+    frame.step = ++steps;
+    frame.published = SDL_GetPerformanceCounter();
+    snapshots.publish();
+}
+
+void SnapshotStats::record(const FrameSnapshot& frame, bool fresh) {
+    if (frame.published == 0) return;
+    double ageMs = (SDL_GetPerformanceCounter() - frame.published) * 1000.0 / SDL_GetPerformanceFrequency();
+    ++frames;
+    if (!fresh) ++repeated;
+    totalAgeMs += ageMs;
+    maxAgeMs = std::max(maxAgeMs, ageMs);
+}
+
+void SnapshotStats::print() const {
+    if (frames == 0) return;
+    std::printf("Snapshot age at present: avg %.2f ms, max %.2f ms over %d frames (%d showed a repeated snapshot)\n",
+                totalAgeMs / frames, maxAgeMs, frames, repeated);
+    std::fflush(stdout);
+}
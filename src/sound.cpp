@@ -0,0 +1,367 @@
+#include "sound.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "log.h"
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+struct SoundInfo {
+    int maxVoices;
+    int priority;
+    float pitchVariation;
+};
+
+const SoundInfo SOUND_INFO[SOUND_COUNT] = {
+    {8, 0, 0.08f},  // SOUND_SLICE
+    {4, 1, 0.03f},  // SOUND_BOMB
+    {1, 2, 0.0f},   // SOUND_GAME_OVER
+};
+
+// There are no sound files in the tree, so the effects are synthesized once at
+// startup into the mixer's output format.
+static void synthesize(SoundId sound, int frequency, std::vector<float>& samples) {
+    const float pi = 3.14159265f;
+    Uint32 noiseState = 0x12345678u;
+    auto noise = [&noiseState] {
+        noiseState = noiseState * 1664525u + 1013904223u;
+        return static_cast<float>(noiseState >> 8) / 8388608.0f - 1.0f;
+    };
+
+    switch (sound) {
+    case SOUND_SLICE: {
+        // A short swish: noise through a lowpass that closes as it decays.
+        int count = frequency * 12 / 100;
+        samples.resize(count);
+        float low = 0;
+        for (int i = 0; i < count; ++i) {
+            float t = static_cast<float>(i) / count;
+            float cutoff = 0.6f - 0.5f * t;
+            low += cutoff * (noise() - low);
+            float envelope = std::min(1.0f, i / (frequency * 0.004f)) * std::exp(-5.0f * t);
+            samples[i] = low * envelope * 0.8f;
+        }
+        break;
+    }
+    case SOUND_BOMB: {
+        // Falling sine thump under a burst of rumbling noise.
+        int count = frequency * 6 / 10;
+        samples.resize(count);
+        float phase = 0, low = 0;
+        for (int i = 0; i < count; ++i) {
+            float t = static_cast<float>(i) / count;
+            phase += 2 * pi * (70.0f - 40.0f * t) / frequency;
+            low += 0.05f * (noise() - low);
+            samples[i] = (0.7f * std::sin(phase) + 2.5f * low) * std::exp(-4.0f * t);
+        }
+        break;
+    }
+    case SOUND_GAME_OVER: {
+        // Three falling notes.
+        const float notes[] = {440.0f, 349.2f, 261.6f};
+        int noteLength = frequency * 3 / 10;
+        samples.resize(noteLength * 3);
+        for (int n = 0; n < 3; ++n) {
+            for (int i = 0; i < noteLength; ++i) {
+                float t = static_cast<float>(i) / noteLength;
+                float value = std::sin(2 * pi * notes[n] * i / frequency) + 0.3f * std::sin(4 * pi * notes[n] * i / frequency);
+                samples[n * noteLength + i] = 0.4f * value * std::min(1.0f, i / (frequency * 0.005f)) * std::exp(-3.0f * t);
+            }
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+bool SoundSystem::init(int bufferSamples) {
+    if (!SDL_WasInit(SDL_INIT_AUDIO) && SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+        LOG_ERROR(LOG_AUDIO, "Failed to initialize audio: {}", SDL_GetError());
+        return false;
+    }
+    if (Mix_OpenAudio(MIX_DEFAULT_FREQUENCY, AUDIO_S16SYS, 2, bufferSamples) != 0) {
+        LOG_ERROR(LOG_AUDIO, "Failed to open audio device: {}", Mix_GetError());
+        return false;
+    }
+    Uint16 format;
+    Mix_QuerySpec(&frequency, &format, &outputChannels);
+    if (format != AUDIO_S16SYS) {
+        LOG_ERROR(LOG_AUDIO, "Unsupported audio format {}", format);
+        Mix_CloseAudio();
+        return false;
+    }
+    // Every effect goes through our mixer, so SDL_mixer has no channels to mix.
+    Mix_AllocateChannels(0);
+
+    for (int id = 0; id < SOUND_COUNT; ++id) {
+        std::vector<float> samples;
+        synthesize(static_cast<SoundId>(id), frequency, samples);
+        pcm[id].resize(samples.size());
+        for (size_t i = 0; i < samples.size(); ++i) {
+            pcm[id][i] = static_cast<Sint16>(std::clamp(samples[i], -1.0f, 1.0f) * 32767.0f);
+        }
+    }
+    for (Voice& voice : voices) {
+        voice.sound = -1;
+    }
+
+    Mix_SetPostMix(postMix, this);
+    open = true;
+    const char* driver = SDL_GetCurrentAudioDriver();
+    LOG_INFO(LOG_AUDIO, "Audio: {}, {} Hz, {} channels, {} sample buffer", driver ? driver : "?", frequency,
+             outputChannels, bufferSamples);
+    return true;
+}
+
+void SoundSystem::shutdown() {
+    if (!open) return;
+    // Mix_SetPostMix takes the audio lock, so the callback is not running once it returns.
+    Mix_SetPostMix(nullptr, nullptr);
+    Mix_CloseAudio();
+    open = false;
+}
+
+bool SoundSystem::play(SoundId sound, float pan, int volume) {
+    if (!open) return false;
+    ++posted;
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    float variation = (static_cast<float>(random >> 8) / 8388608.0f - 1.0f) * SOUND_INFO[sound].pitchVariation;
+    SoundCommand command = {sound, static_cast<float>(volume) / MIX_MAX_VOLUME, std::clamp(pan, -1.0f, 1.0f), 1.0f + variation};
+    if (!queue.push(command)) {
+        ++dropped;
+        return false;
+    }
+    return true;
+}
+
+SoundStats SoundSystem::stats() const {
+    double frequencyUs = SDL_GetPerformanceFrequency() / 1e6;
+    int count = callbacks.load();
+    SoundStats stats;
+    stats.posted = posted.load();
+    stats.dropped = dropped.load();
+    stats.played = played.load();
+    stats.stolen = stolen.load();
+    stats.callbacks = count;
+    stats.mixAverageUs = count > 0 ? mixTicks.load() / frequencyUs / count : 0;
+    stats.mixMaxUs = mixMaxTicks.load() / frequencyUs;
+    stats.bufferMs = frequency > 0 ? bufferFrames * 1000.0 / frequency : 0;
+    return stats;
+}
+
+void SoundSystem::postMix(void* userdata, Uint8* stream, int length) {
+    SoundSystem* system = static_cast<SoundSystem*>(userdata);
+    system->mix(reinterpret_cast<Sint16*>(stream), length / static_cast<int>(sizeof(Sint16) * system->outputChannels));
+}
+
+int SoundSystem::pickVoice(SoundId sound) {
+    int sameCount = 0, oldestSame = -1, freeVoice = -1, victim = -1;
+    for (int i = 0; i < MAX_VOICES; ++i) {
+        const Voice& voice = voices[i];
+        if (voice.sound < 0) {
+            if (freeVoice < 0) freeVoice = i;
+            continue;
+        }
+        if (voice.sound == sound) {
+            ++sameCount;
+            if (oldestSame < 0 || voice.started < voices[oldestSame].started) oldestSame = i;
+        }
+        // Prefer stealing the lowest priority, then the oldest.
+        int priority = SOUND_INFO[voice.sound].priority;
+        if (priority <= SOUND_INFO[sound].priority &&
+            (victim < 0 || priority < SOUND_INFO[voices[victim].sound].priority ||
+             (priority == SOUND_INFO[voices[victim].sound].priority && voice.started < voices[victim].started))) {
+            victim = i;
+        }
+    }
+    if (sameCount >= SOUND_INFO[sound].maxVoices) {
+        ++stolen;
+        return oldestSame;
+    }
+    if (freeVoice >= 0) return freeVoice;
+    if (victim >= 0) ++stolen;
+    return victim;
+}
+
+void SoundSystem::start(const SoundCommand& command) {
+    int index = pickVoice(command.sound);
+    if (index < 0 || pcm[command.sound].size() < 2) {
+        ++dropped;
+        return;
+    }
+    // Constant-power pan: left^2 + right^2 stays 1 across the field.
+    float angle = (command.pan + 1.0f) * 0.785398163f;
+    Voice& voice = voices[index];
+    voice.samples = pcm[command.sound].data();
+    voice.length = static_cast<int>(pcm[command.sound].size());
+    voice.position = 0;
+    voice.step = command.pitch;
+    voice.gainLeft = std::cos(angle) * command.volume;
+    voice.gainRight = std::sin(angle) * command.volume;
+    voice.sound = command.sound;
+    voice.started = ++sequence;
+    ++played;
+}
+
+// Resamples one voice by linear interpolation and accumulates it, panned, into
+// the planar left/right block. Four output frames per iteration with SSE2.
+void SoundSystem::mixVoice(Voice& voice, float* left, float* right, int frames) {
+    double remaining = (voice.length - 1 - voice.position) / voice.step;
+    int count = std::min(frames, static_cast<int>(std::ceil(remaining)));
+    if (count <= 0) {
+        voice.sound = -1;
+        return;
+    }
+    const float scale = 1.0f / 32768.0f;
+    int base = static_cast<int>(voice.position);
+    float frac = static_cast<float>(voice.position - base);
+    const Sint16* samples = voice.samples + base;
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 offsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 step = _mm_set1_ps(voice.step);
+    const __m128 gainLeft = _mm_set1_ps(voice.gainLeft * scale);
+    const __m128 gainRight = _mm_set1_ps(voice.gainRight * scale);
+    alignas(16) int index[4];
+    for (; i + 4 <= count; i += 4) {
+        __m128 position = _mm_add_ps(_mm_set1_ps(frac), _mm_mul_ps(step, _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), offsets)));
+        __m128i whole = _mm_cvttps_epi32(position);
+        __m128 t = _mm_sub_ps(position, _mm_cvtepi32_ps(whole));
+        _mm_store_si128(reinterpret_cast<__m128i*>(index), whole);
+        __m128 a = _mm_setr_ps(samples[index[0]], samples[index[1]], samples[index[2]], samples[index[3]]);
+        __m128 b = _mm_setr_ps(samples[index[0] + 1], samples[index[1] + 1], samples[index[2] + 1], samples[index[3] + 1]);
+        __m128 value = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+        _mm_store_ps(left + i, _mm_add_ps(_mm_load_ps(left + i), _mm_mul_ps(value, gainLeft)));
+        _mm_store_ps(right + i, _mm_add_ps(_mm_load_ps(right + i), _mm_mul_ps(value, gainRight)));
+    }
+#endif
+    for (; i < count; ++i) {
+        float position = frac + voice.step * i;
+        int whole = static_cast<int>(position);
+        float t = position - whole;
+        float value = (samples[whole] + (samples[whole + 1] - samples[whole]) * t) * scale;
+        left[i] += value * voice.gainLeft;
+        right[i] += value * voice.gainRight;
+    }
+    voice.position = base + frac + static_cast<double>(voice.step) * count;
+    if (count < frames) {
+        voice.sound = -1;
+    }
+}
+
+// Audio thread: start queued sounds, then add every voice on top of the music
+// already in the stream, saturating to int16.
+void SoundSystem::mix(Sint16* out, int frames) {
+    Uint64 startTicks = SDL_GetPerformanceCounter();
+    SoundCommand command;
+    while (queue.pop(command)) {
+        start(command);
+    }
+
+    for (int done = 0; done < frames; done += SOUND_MIX_BLOCK) {
+        int count = std::min(SOUND_MIX_BLOCK, frames - done);
+        std::memset(left, 0, sizeof(float) * count);
+        std::memset(right, 0, sizeof(float) * count);
+        for (Voice& voice : voices) {
+            if (voice.sound >= 0) {
+                mixVoice(voice, left, right, count);
+            }
+        }
+
+        Sint16* dst = out + static_cast<size_t>(done) * outputChannels;
+        int i = 0;
+        if (outputChannels == 2) {
+#if defined(__SSE2__)
+            const __m128 full = _mm_set1_ps(32767.0f);
+            const __m128 limit = _mm_set1_ps(65536.0f);
+            for (; i + 4 <= count; i += 4) {
+                __m128i existing = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i * 2));
+                __m128i existingLow = _mm_srai_epi32(_mm_unpacklo_epi16(existing, existing), 16);
+                __m128i existingHigh = _mm_srai_epi32(_mm_unpackhi_epi16(existing, existing), 16);
+                __m128 l = _mm_load_ps(left + i);
+                __m128 r = _mm_load_ps(right + i);
+                __m128 low = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_unpacklo_ps(l, r), full), limit), _mm_sub_ps(_mm_setzero_ps(), limit));
+                __m128 high = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_unpackhi_ps(l, r), full), limit), _mm_sub_ps(_mm_setzero_ps(), limit));
+                __m128i sumLow = _mm_add_epi32(existingLow, _mm_cvtps_epi32(low));
+                __m128i sumHigh = _mm_add_epi32(existingHigh, _mm_cvtps_epi32(high));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm_packs_epi32(sumLow, sumHigh));
+            }
+#endif
+            for (; i < count; ++i) {
+                dst[i * 2] = static_cast<Sint16>(std::clamp(dst[i * 2] + static_cast<int>(std::lrint(left[i] * 32767.0f)), -32768, 32767));
+                dst[i * 2 + 1] = static_cast<Sint16>(std::clamp(dst[i * 2 + 1] + static_cast<int>(std::lrint(right[i] * 32767.0f)), -32768, 32767));
+            }
+        } else {
+            for (; i < count; ++i) {
+                Sint16* frame = dst + i * outputChannels;
+                if (outputChannels == 1) {
+                    frame[0] = static_cast<Sint16>(std::clamp(frame[0] + static_cast<int>((left[i] + right[i]) * 16383.5f), -32768, 32767));
+                    continue;
+                }
+                frame[0] = static_cast<Sint16>(std::clamp(frame[0] + static_cast<int>(left[i] * 32767.0f), -32768, 32767));
+                frame[1] = static_cast<Sint16>(std::clamp(frame[1] + static_cast<int>(right[i] * 32767.0f), -32768, 32767));
+            }
+        }
+    }
+
+    Uint64 ticks = SDL_GetPerformanceCounter() - startTicks;
+    mixTicks.fetch_add(ticks, std::memory_order_relaxed);
+    if (ticks > mixMaxTicks.load(std::memory_order_relaxed)) {
+        mixMaxTicks.store(ticks, std::memory_order_relaxed);
+    }
+    bufferFrames = frames;
+    callbacks.fetch_add(1, std::memory_order_relaxed);
+}
+
+void runAudioStress(int frames, int bufferSamples) {
+    SDL_Init(SDL_INIT_AUDIO | SDL_INIT_TIMER);
+    SoundSystem sound;
+    if (!sound.init(bufferSamples)) {
+        SDL_Quit();
+        return;
+    }
+    const double frameMs = 16.0;
+    double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    double maxPostUs = 0, totalPostUs = 0, maxFrameMs = 0, totalFrameMs = 0;
+    int hitches = 0;
+    Uint64 frameStart = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < frames; ++frame) {
+        for (int i = 0; i < AUDIO_STRESS_PER_FRAME; ++i) {
+            float pan = ((frame * AUDIO_STRESS_PER_FRAME + i) % 17) / 8.0f - 1.0f;
+            Uint64 start = SDL_GetPerformanceCounter();
+            sound.play(SOUND_SLICE, pan, MIX_MAX_VOLUME / 4);
+            double us = (SDL_GetPerformanceCounter() - start) * 1e6 / frequency;
+            maxPostUs = std::max(maxPostUs, us);
+            totalPostUs += us;
+        }
+        if (frame % 30 == 0) {
+            sound.play(SOUND_BOMB, 0.0f, MIX_MAX_VOLUME / 4);
+        }
+        double elapsed = (SDL_GetPerformanceCounter() - frameStart) * 1000.0 / frequency;
+        if (elapsed < frameMs) {
+            SDL_Delay(static_cast<Uint32>(frameMs - elapsed));
+        }
+        Uint64 now = SDL_GetPerformanceCounter();
+        double took = (now - frameStart) * 1000.0 / frequency;
+        frameStart = now;
+        maxFrameMs = std::max(maxFrameMs, took);
+        totalFrameMs += took;
+        if (took > frameMs * 1.5) ++hitches;
+    }
+    SoundStats stats = sound.stats();
+    int posts = frames * AUDIO_STRESS_PER_FRAME;
+    std::printf("audio stress: %d frames, %.0f slice sounds/s\n", frames, AUDIO_STRESS_PER_FRAME * 1000.0 / frameMs);
+    std::printf("  post: avg %.2f us, max %.2f us\n", totalPostUs / posts, maxPostUs);
+    std::printf("  frame: avg %.2f ms, max %.2f ms, %d hitches over %.0f ms\n", totalFrameMs / frames, maxFrameMs, hitches, frameMs * 1.5);
+    std::printf("  mixer: %d callbacks, avg %.1f us, max %.1f us per %.1f ms buffer (%.2f%% of the audio thread)\n", stats.callbacks,
+                stats.mixAverageUs, stats.mixMaxUs, stats.bufferMs, stats.bufferMs > 0 ? stats.mixAverageUs / (stats.bufferMs * 10.0) : 0.0);
+    std::printf("  posted %d, played %d, stolen %d, dropped %d\n", stats.posted, stats.played, stats.stolen, stats.dropped);
+    std::fflush(stdout);
+    sound.shutdown();
+    SDL_Quit();
+}
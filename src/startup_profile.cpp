@@ -0,0 +1,56 @@
+#include "startup_profile.h"
+#include <cstdio>
+#include "log.h"
+
+StartupProfile::StartupProfile() : origin(SDL_GetPerformanceCounter()) {}
+
+double StartupProfile::toMs(Uint64 ticks) const {
+    return (ticks - origin) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+double StartupProfile::elapsedMs() const {
+    return toMs(now());
+}
+
+void StartupProfile::record(const std::string& name, Uint64 start) {
+    double startMs = toMs(start);
+    events.push_back({name, startMs, elapsedMs() - startMs});
+}
+
+void StartupProfile::add(const std::string& name, double durationMs) {
+    events.push_back({name, elapsedMs() - durationMs, durationMs});
+}
+
+void StartupProfile::print() const {
+    std::printf("%-40s %10s %10s\n", "step", "start ms", "took ms");
+    for (const Event& event : events) {
+        std::printf("%-40s %10.2f %10.2f\n", event.name.c_str(), event.startMs, event.durationMs);
+    }
+    std::fflush(stdout);
+}
+
+static void writeJsonString(FILE* file, const std::string& text) {
+    std::fputc('"', file);
+    for (char c : text) {
+        if (c == '"' || c == '\\') std::fputc('\\', file);
+        std::fputc(c, file);
+    }
+    std::fputc('"', file);
+}
+
+bool StartupProfile::writeJson(const std::string& path) const {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        LOG_ERROR(LOG_CORE, "Failed to write {}", path);
+        return false;
+    }
+    std::fprintf(file, "{\n  \"total_ms\": %.3f,\n  \"events\": [", elapsedMs());
+    for (size_t i = 0; i < events.size(); ++i) {
+        std::fprintf(file, "%s\n    {\"name\": ", i ? "," : "");
+        writeJsonString(file, events[i].name);
+        std::fprintf(file, ", \"start_ms\": %.3f, \"duration_ms\": %.3f}", events[i].startMs, events[i].durationMs);
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+    std::fclose(file);
+    return true;
+}
@@ -0,0 +1,272 @@
+#include "stress.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "draw.h"
+#include "frame_memory.h"
+#include "game_events.h"
+#include "log.h"
+#include "object_update.h"
+#include "particles.h"
+#include "render_backend.h"
+
+struct StressPoint {
+    int entities = 0;
+    int frames = 0;
+    double updateMs = 0, sliceMs = 0, renderMs = -1;
+    double slicesPerFrame = 0;
+    // Particles and fragments the reactions produced, and those that did not
+    // fit the particle pool or the object capacity. Once anything is dropped
+    // the slice stage no longer does work in proportion to the cuts.
+    double particlesPerFrame = 0, particlesDroppedPerFrame = 0;
+    double fragmentsPerFrame = 0, fragmentsDroppedPerFrame = 0;
+};
+
+struct StressRenderer {
+    SDL_Renderer* renderer = nullptr;
+    SDL_Texture* background = nullptr;
+    SDL_Texture* bomb = nullptr;
+    int bombW = 0, bombH = 0;
+    ParticleRenderer particles;
+    ParticleFrame particleFrame;
+};
+
+static GameObject spawnObject(const StressConfig& config, bool anywhere, Random& random) {
+    int total = std::max(1, config.fruitShare + config.bombShare + config.fragmentShare);
+    int pick = random.below(total);
+    ObjectType type = pick < config.fruitShare ? FRUIT : (pick < config.fruitShare + config.bombShare ? BOMB : FRAGMENT);
+    int x = random.below(std::max(1, config.width - OBJECT_SIZE));
+    int y = anywhere || type == FRAGMENT ? random.below(config.height) : config.height;
+    int direction = random.below(2) ? 1 : -1;
+    return GameObject(x, y, type, random, direction, config.height);
+}
+
+// A Lissajous sweep over the whole playfield, fast enough to always count as a cut.
+static void bladeAt(const StressConfig& config, int frame, int& x, int& y) {
+    x = config.width / 2 + static_cast<int>((config.width / 2 - 1) * std::sin(frame * 0.13));
+    y = config.height / 2 + static_cast<int>((config.height / 2 - 1) * std::sin(frame * 0.07));
+}
+
+// Same drawing as the game's SDL path, at the stress playfield size.
+static void renderFrame(StressRenderer& target, const std::vector<GameObject>& objects, const StressConfig& config) {
+    SDL_Renderer* renderer = target.renderer;
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    if (target.background) {
+        SDL_RenderCopy(renderer, target.background, NULL, NULL);
+    }
+    for (const GameObject& obj : objects) {
+        if (obj.type == BOMB) {
+            if (target.bomb && obj.x >= 0 && obj.x < config.width && obj.y >= 0 && obj.y < config.height) {
+                SDL_Rect bomRect = {obj.x, obj.y, target.bombW / 2, target.bombH / 2};
+                SDL_RenderCopy(renderer, target.bomb, NULL, &bomRect);
+            }
+            continue;
+        }
+        if (obj.type == FRUIT) SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+        else SDL_SetRenderDrawColor(renderer, 255, 165, 0, 255);
+        drawCircle(renderer, obj.x + OBJECT_SIZE / 4, obj.y + OBJECT_SIZE / 4, OBJECT_SIZE / 4);
+    }
+    target.particles.render(renderer, target.particleFrame);
+    SDL_RenderPresent(renderer);
+}
+
+static StressPoint runPoint(const StressConfig& config, int entities, JobSystem& jobs, StressRenderer* target) {
+    const int capacity = entities * 2 + 1024;
+    const int radius = OBJECT_SIZE / 4;
+    const double toMs = 1000.0 / SDL_GetPerformanceFrequency();
+    Random random;
+    random.seed(entities);
+
+    std::vector<GameObject> objects;
+    objects.reserve(capacity);
+    for (int i = 0; i < entities; ++i) {
+        objects.push_back(spawnObject(config, true, random));
+    }
+    ObjectUpdater updater;
+    updater.reserve(capacity);
+    updater.setFloor(config.height);
+    FrameArena arena;
+    arena.init(ObjectUpdater::scratchBytes(capacity));
+    GameEventBuffer events;
+    events.reserve(capacity);
+    ParticleSystem particles;
+    if (target) target->particleFrame.reserve();
+
+    StressPoint point;
+    point.entities = entities;
+    double measuredMs = 0, renderMs = 0;
+    long slices = 0;
+    long emitted = 0, emitDropped = 0, fragments = 0, fragmentsDropped = 0;
+    int prevX, prevY;
+    bladeAt(config, 0, prevX, prevY);
+    for (int frame = 1; frame <= config.frames; ++frame) {
+        SDL_PumpEvents();
+        arena.reset();
+        events.clear();
+        Blade blade = {true, prevX, prevY, 0, 0};
+        bladeAt(config, frame, blade.x, blade.y);
+        prevX = blade.x;
+        prevY = blade.y;
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        updater.update(objects, blade, &jobs, arena, events);
+        Uint64 updated = SDL_GetPerformanceCounter();
+        for (const GameEvent& event : events.all()) {
+            if (event.type == EVENT_SLICE) {
+                int count = particles.emit(JUICE_EMITTER, event.x + radius, event.y + radius, 40);
+                emitted += count;
+                emitDropped += 40 - count;
+                if (objects.size() + 2 > static_cast<size_t>(capacity)) {
+                    fragmentsDropped += 2;
+                    continue;
+                }
+                objects.push_back(GameObject(event.x, event.y, FRAGMENT, random, -1, config.height));
+                objects.push_back(GameObject(event.x + radius, event.y, FRAGMENT, random, 1, config.height));
+                fragments += 2;
+            } else if (event.type == EVENT_BOMB_HIT) {
+                int count = particles.emit(BLAST_EMITTER, event.x + radius, event.y + radius, 200);
+                emitted += count;
+                emitDropped += 200 - count;
+            }
+        }
+        particles.update(&jobs);
+        Uint64 reacted = SDL_GetPerformanceCounter();
+        point.updateMs += (updated - start) * toMs;
+        point.sliceMs += (reacted - updated) * toMs;
+        measuredMs += (reacted - start) * toMs;
+        slices += events.count(EVENT_SLICE) + events.count(EVENT_BOMB_HIT);
+
+        int missing = entities - static_cast<int>(objects.size());
+        if (config.spawnRate > 0) missing = std::min(missing, config.spawnRate);
+        for (int i = 0; i < missing; ++i) {
+            objects.push_back(spawnObject(config, false, random));
+        }
+
+        if (target) {
+            particles.snapshot(target->particleFrame);
+            start = SDL_GetPerformanceCounter();
+            renderFrame(*target, objects, config);
+            double ms = (SDL_GetPerformanceCounter() - start) * toMs;
+            renderMs += ms;
+            measuredMs += ms;
+        }
+        point.frames = frame;
+        if (frame >= STRESS_MIN_FRAMES && measuredMs > STRESS_POINT_BUDGET_MS) break;
+    }
+    point.updateMs /= point.frames;
+    point.sliceMs /= point.frames;
+    if (target) point.renderMs = renderMs / point.frames;
+    point.slicesPerFrame = static_cast<double>(slices) / point.frames;
+    point.particlesPerFrame = static_cast<double>(emitted) / point.frames;
+    point.particlesDroppedPerFrame = static_cast<double>(emitDropped) / point.frames;
+    point.fragmentsPerFrame = static_cast<double>(fragments) / point.frames;
+    point.fragmentsDroppedPerFrame = static_cast<double>(fragmentsDropped) / point.frames;
+    return point;
+}
+
+// Small counts are dominated by fixed costs, so the cost per entity falls to a
+// minimum first. The stage scales linearly from there up to the last count
+// whose cost per entity stays within twice that minimum. Only the first
+// usable points count. 0 if never measured.
+static int linearLimit(const std::vector<StressPoint>& points, double StressPoint::*ms, size_t usable) {
+    size_t measured = 0, best = 0;
+    while (measured < std::min(usable, points.size()) && points[measured].*ms >= 0) {
+        const StressPoint& point = points[measured];
+        if (point.*ms / point.entities < points[best].*ms / points[best].entities) best = measured;
+        ++measured;
+    }
+    if (measured == 0) return 0;
+    double bestPerEntity = points[best].*ms / points[best].entities;
+    size_t limit = best;
+    while (limit + 1 < measured && points[limit + 1].*ms / points[limit + 1].entities <= bestPerEntity * 2) {
+        ++limit;
+    }
+    return points[limit].entities;
+}
+
+bool runStressScene(const StressConfig& config, SDL_Surface* background, SDL_Surface* bomb, JobSystem& jobs) {
+    FILE* csv = std::fopen(config.csvPath.c_str(), "w");
+    if (!csv) {
+        LOG_ERROR(LOG_CORE, "Failed to write {}", config.csvPath);
+        return false;
+    }
+
+    SDL_Window* window = nullptr;
+    StressRenderer target;
+    if (config.render) {
+        window = SDL_CreateWindow("Fruit Slicer - stress", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                  config.width, config.height, SDL_WINDOW_SHOWN);
+        if (!window) {
+            LOG_ERROR(LOG_RENDER, "Failed to create window: {}", SDL_GetError());
+        } else {
+            target.renderer = createRenderer(window, config.renderer);
+        }
+        if (target.renderer) {
+            target.background = background ? SDL_CreateTextureFromSurface(target.renderer, background) : nullptr;
+            target.bomb = bomb ? SDL_CreateTextureFromSurface(target.renderer, bomb) : nullptr;
+            if (target.bomb) SDL_QueryTexture(target.bomb, NULL, NULL, &target.bombW, &target.bombH);
+        }
+    }
+
+    std::printf("Stress scene %dx%d, up to %d frames per point, %d job threads\n", config.width, config.height,
+                config.frames, jobs.concurrency());
+    std::printf("%9s %6s %10s %10s %10s %10s %12s\n", "entities", "frames", "update ms", "slice ms", "render ms", "cuts/frame",
+                "dropped/frm");
+    std::fprintf(csv, "entities,frames,update_ms,slice_ms,render_ms,update_ns_per_entity,render_ns_per_entity,cuts_per_frame,"
+                      "particles_per_frame,particles_dropped_per_frame,fragments_per_frame,fragments_dropped_per_frame\n");
+
+    std::vector<StressPoint> points;
+    bool rendering = target.renderer != nullptr;
+    for (double count = STRESS_MIN_ENTITIES;; count *= std::sqrt(10.0)) {
+        int entities = std::min(config.maxEntities, static_cast<int>(std::lround(count)));
+        StressPoint point = runPoint(config, entities, jobs, rendering ? &target : nullptr);
+        points.push_back(point);
+        if (point.renderMs > STRESS_RENDER_LIMIT_MS) rendering = false;
+
+        char render[32] = "";
+        char renderPerEntity[32] = "";
+        if (point.renderMs >= 0) {
+            std::snprintf(render, sizeof(render), "%.4f", point.renderMs);
+            std::snprintf(renderPerEntity, sizeof(renderPerEntity), "%.2f", point.renderMs * 1e6 / entities);
+        }
+        std::fprintf(csv, "%d,%d,%.4f,%.4f,%s,%.2f,%s,%.2f,%.1f,%.1f,%.1f,%.1f\n", entities, point.frames, point.updateMs,
+                     point.sliceMs, render, point.updateMs * 1e6 / entities, renderPerEntity, point.slicesPerFrame,
+                     point.particlesPerFrame, point.particlesDroppedPerFrame, point.fragmentsPerFrame,
+                     point.fragmentsDroppedPerFrame);
+        std::printf("%9d %6d %10.3f %10.3f %10s %10.1f %12.1f\n", entities, point.frames, point.updateMs, point.sliceMs,
+                    point.renderMs >= 0 ? render : "-", point.slicesPerFrame,
+                    point.particlesDroppedPerFrame + point.fragmentsDroppedPerFrame);
+        std::fflush(stdout);
+        if (entities >= config.maxEntities) break;
+    }
+    std::fclose(csv);
+
+    // Past the first point that dropped particles or fragments, the slice
+    // stage is capped by the pools rather than the entity count.
+    size_t unsaturated = 0;
+    while (unsaturated < points.size() &&
+           points[unsaturated].particlesDroppedPerFrame + points[unsaturated].fragmentsDroppedPerFrame == 0) {
+        ++unsaturated;
+    }
+    std::printf("Cost per entity within 2x of its best up to: update %d, slice %d",
+                linearLimit(points, &StressPoint::updateMs, points.size()),
+                linearLimit(points, &StressPoint::sliceMs, unsaturated));
+    int renderLimit = linearLimit(points, &StressPoint::renderMs, points.size());
+    if (renderLimit > 0) std::printf(", render %d", renderLimit);
+    std::printf(" entities\n");
+    if (unsaturated < points.size()) {
+        std::printf("Slice reactions saturate the particle pool or object capacity from %d entities; later slice times "
+                    "cover only what fit\n",
+                    points[unsaturated].entities);
+    }
+    std::printf("Wrote %s\n", config.csvPath.c_str());
+    std::fflush(stdout);
+
+    SDL_DestroyTexture(target.bomb);
+    SDL_DestroyTexture(target.background);
+    if (target.renderer) SDL_DestroyRenderer(target.renderer);
+    if (window) SDL_DestroyWindow(window);
+    return true;
+}
@@ -0,0 +1,191 @@
+#include "text.h"
+#include <SDL2/SDL_ttf.h>
+#include <algorithm>
+#include "log.h"
+#if __has_include("baked_font_data.h")
+#include "baked_font_data.h"
+#define HAVE_BAKED_FONTS
+#endif
+
+const BakedFont* findBakedFont(const std::string& name, int size) {
+#ifdef HAVE_BAKED_FONTS
+    for (const BakedFont& font : BAKED_FONTS) {
+        if (name == font.name && size == font.size) {
+            return &font;
+        }
+    }
+#else
+    (void)name;
+    (void)size;
+#endif
+    return nullptr;
+}
+
+bool Font::open(AssetManager& assets, const std::string& name, int size, bool allowBaked) {
+    close();
+    baked = allowBaked ? findBakedFont(name, size) : nullptr;
+    if (baked) {
+        vertices.reserve(4 * FONT_DRAW_RESERVE);
+        indices.reserve(6 * FONT_DRAW_RESERVE);
+        return true;
+    }
+
+    if (!TTF_WasInit() && TTF_Init() != 0) {
+        LOG_ERROR(LOG_RENDER, "Failed to initialize SDL_ttf: {}", TTF_GetError());
+        return false;
+    }
+    ttf = assets.loadFont(name, size);
+    return static_cast<bool>(ttf);
+}
+
+void Font::close() {
+    SDL_DestroyTexture(atlasTexture);
+    atlasTexture = nullptr;
+    atlasRenderer = nullptr;
+    baked = nullptr;
+    ttf.reset();
+}
+
+int Font::height() const {
+    if (baked) return baked->height;
+    return ttf ? TTF_FontHeight(ttf.get()) : 0;
+}
+
+const BakedGlyph* Font::glyph(char c) const {
+    if (c < BAKED_FIRST_CHAR || c > BAKED_LAST_CHAR) return nullptr;
+    return &baked->glyphs[c - BAKED_FIRST_CHAR];
+}
+
+int Font::kerning(char first, char second) const {
+    const BakedKerning* begin = baked->kerning;
+    const BakedKerning* end = begin + baked->kerningCount;
+    const BakedKerning* found = std::lower_bound(begin, end, std::make_pair(first, second), [](const BakedKerning& k, std::pair<char, char> key) {
+        return k.first != static_cast<Uint8>(key.first) ? k.first < static_cast<Uint8>(key.first) : k.second < static_cast<Uint8>(key.second);
+    });
+    if (found != end && found->first == static_cast<Uint8>(first) && found->second == static_cast<Uint8>(second)) {
+        return found->amount;
+    }
+    return 0;
+}
+
+void Font::measure(const char* text, int& w, int& h) const {
+    w = h = 0;
+    if (!baked) {
+        if (ttf) TTF_SizeText(ttf.get(), text, &w, &h);
+        return;
+    }
+    int penX = 0;
+    char previous = 0;
+    for (const char* c = text; *c; ++c) {
+        const BakedGlyph* g = glyph(*c);
+        if (!g) continue;
+        if (previous) penX += kerning(previous, *c);
+        w = std::max(w, penX + g->offsetX + g->w);
+        penX += g->advance;
+        previous = *c;
+    }
+    w = std::max(w, penX);
+    h = baked->height;
+}
+
+SDL_Surface* Font::renderSurface(const char* text, SDL_Color color) const {
+    if (!baked) {
+        return ttf ? TTF_RenderText_Blended(ttf.get(), text, color) : nullptr;
+    }
+    int w, h;
+    measure(text, w, h);
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, std::max(w, 1), std::max(h, 1), 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!surface) return nullptr;
+    SDL_FillRect(surface, NULL, 0);
+
+    Uint32 rgb = (static_cast<Uint32>(color.r) << 16) | (static_cast<Uint32>(color.g) << 8) | color.b;
+    int penX = 0;
+    char previous = 0;
+    for (const char* c = text; *c; ++c) {
+        const BakedGlyph* g = glyph(*c);
+        if (!g) continue;
+        if (previous) penX += kerning(previous, *c);
+        for (int y = 0; y < g->h; ++y) {
+            int dy = g->offsetY + y;
+            if (dy < 0 || dy >= surface->h) continue;
+            Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(surface->pixels) + dy * surface->pitch);
+            const Uint8* coverage = baked->atlas + (g->y + y) * BAKED_ATLAS_WIDTH + g->x;
+            for (int x = 0; x < g->w; ++x) {
+                int dx = penX + g->offsetX + x;
+                if (dx < 0 || dx >= surface->w) continue;
+                Uint32 alpha = coverage[x] * color.a / 255;
+                // Overlapping glyphs keep the stronger coverage instead of summing.
+                if (alpha > (row[dx] >> 24)) {
+                    row[dx] = (alpha << 24) | rgb;
+                }
+            }
+        }
+        penX += g->advance;
+        previous = *c;
+    }
+    return surface;
+}
+
+bool Font::createAtlas(SDL_Renderer* renderer) {
+    SDL_DestroyTexture(atlasTexture);
+    atlasRenderer = renderer;
+    atlasTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, BAKED_ATLAS_WIDTH, baked->atlasHeight);
+    if (!atlasTexture) {
+        LOG_ERROR(LOG_RENDER, "Failed to create font atlas: {}", SDL_GetError());
+        return false;
+    }
+    std::vector<Uint32> pixels(static_cast<size_t>(BAKED_ATLAS_WIDTH) * baked->atlasHeight);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = (static_cast<Uint32>(baked->atlas[i]) << 24) | 0xFFFFFF;
+    }
+    SDL_UpdateTexture(atlasTexture, NULL, pixels.data(), BAKED_ATLAS_WIDTH * 4);
+    SDL_SetTextureBlendMode(atlasTexture, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+void Font::draw(SDL_Renderer* renderer, const char* text, int x, int y, SDL_Color color) {
+    if (!baked) {
+        SDL_Surface* surface = renderSurface(text, color);
+        if (!surface) return;
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+        if (texture) {
+            SDL_Rect rect = {x, y, surface->w, surface->h};
+            SDL_RenderCopy(renderer, texture, NULL, &rect);
+            SDL_DestroyTexture(texture);
+        }
+        SDL_FreeSurface(surface);
+        return;
+    }
+    if ((renderer != atlasRenderer || !atlasTexture) && !createAtlas(renderer)) return;
+
+    // One quad per glyph, all drawn from the atlas in a single geometry call.
+    vertices.clear();
+    indices.clear();
+    float invW = 1.0f / BAKED_ATLAS_WIDTH;
+    float invH = 1.0f / baked->atlasHeight;
+    int penX = x;
+    char previous = 0;
+    for (const char* c = text; *c; ++c) {
+        const BakedGlyph* g = glyph(*c);
+        if (!g) continue;
+        if (previous) penX += kerning(previous, *c);
+        if (g->w > 0) {
+            float left = static_cast<float>(penX + g->offsetX), top = static_cast<float>(y + g->offsetY);
+            float right = left + g->w, bottom = top + g->h;
+            float u0 = g->x * invW, v0 = g->y * invH, u1 = (g->x + g->w) * invW, v1 = (g->y + g->h) * invH;
+            int base = static_cast<int>(vertices.size());
+            vertices.push_back({{left, top}, color, {u0, v0}});
+            vertices.push_back({{right, top}, color, {u1, v0}});
+            vertices.push_back({{right, bottom}, color, {u1, v1}});
+            vertices.push_back({{left, bottom}, color, {u0, v1}});
+            for (int i : {0, 1, 2, 0, 2, 3}) {
+                indices.push_back(base + i);
+            }
+        }
+        penX += g->advance;
+        previous = *c;
+    }
+    if (!indices.empty()) {
+        SDL_RenderGeometry(renderer, atlasTexture, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size()));
+    }
+}
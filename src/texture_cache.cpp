@@ -0,0 +1,175 @@
+#include "texture_cache.h"
+#include <zstd.h>
+#include <cstring>
+#include "log.h"
+
+const int TEXTURE_CACHE_LEVEL = 3;
+// Larger than any texture a renderer accepts; bounds what a corrupt header can ask for.
+const int TEXTURE_CACHE_MAX_SIDE = 16384;
+
+bool TextureCache::init(SDL_Renderer* renderer) {
+    this->renderer = renderer;
+    char* prefPath = SDL_GetPrefPath("fruitss", "FruitSlicer");
+    if (!prefPath) {
+        LOG_WARN(LOG_RENDER, "Texture cache disabled: {}", SDL_GetError());
+        return false;
+    }
+    directory = prefPath;
+    SDL_free(prefPath);
+
+    SDL_RendererInfo info;
+    nativeFormat = SDL_PIXELFORMAT_ARGB8888;
+    if (SDL_GetRendererInfo(renderer, &info) == 0) {
+        for (Uint32 i = 0; i < info.num_texture_formats; ++i) {
+            Uint32 format = info.texture_formats[i];
+            if (!SDL_ISPIXELFORMAT_FOURCC(format) && SDL_BYTESPERPIXEL(format) == 4 && SDL_ISPIXELFORMAT_ALPHA(format)) {
+                nativeFormat = format;
+                break;
+            }
+        }
+    }
+
+    // Renderers without custom blend modes (the software one) get straight alpha.
+    premultipliedBlend = SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                                                    SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+    SDL_Texture* probe = SDL_CreateTexture(renderer, nativeFormat, SDL_TEXTUREACCESS_STATIC, 1, 1);
+    premultiply = probe && SDL_SetTextureBlendMode(probe, premultipliedBlend) == 0;
+    SDL_DestroyTexture(probe);
+    return true;
+}
+
+Uint64 TextureCache::hash(const void* data, size_t size) {
+    const Uint8* bytes = static_cast<const Uint8*>(data);
+    Uint64 value = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+        value = (value ^ bytes[i]) * 1099511628211ULL;
+    }
+    return value;
+}
+
+std::string TextureCache::pathFor(const std::string& name) const {
+    std::string file = name;
+    for (char& c : file) {
+        if (c == '/' || c == '\\' || c == '.' || c == ':') c = '_';
+    }
+    return directory + "texcache_" + file + ".ftex";
+}
+
+bool TextureCache::lookup(const std::string& name, Uint64 sourceHash, CachedTexture& cached) const {
+    if (directory.empty()) return false;
+    SDL_RWops* file = SDL_RWFromFile(pathFor(name).c_str(), "rb");
+    if (!file) return false;
+    TextureCacheHeader header;
+    bool valid = SDL_RWread(file, &header, sizeof(header), 1) == 1 &&
+                 memcmp(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic)) == 0 &&
+                 header.version == TEXTURE_CACHE_VERSION && header.sourceHash == sourceHash &&
+                 header.format == nativeFormat && (header.premultiplied != 0) == premultiply && header.w > 0 && header.h > 0 &&
+                 header.w <= TEXTURE_CACHE_MAX_SIDE && header.h <= TEXTURE_CACHE_MAX_SIDE;
+    // store() writes exactly the header and the compressed pixels, so any
+    // other file length means a truncated or corrupted entry.
+    Sint64 fileSize = SDL_RWsize(file);
+    valid = valid && fileSize >= 0 && header.compressedSize == static_cast<Uint64>(fileSize) - sizeof(header);
+    if (valid) {
+        cached.compressed.resize(header.compressedSize);
+        valid = SDL_RWread(file, cached.compressed.data(), 1, header.compressedSize) == header.compressedSize;
+    }
+    SDL_RWclose(file);
+    if (!valid) {
+        cached.compressed.clear();
+        return false;
+    }
+    cached.format = header.format;
+    cached.w = header.w;
+    cached.h = header.h;
+    cached.premultiplied = header.premultiplied != 0;
+    return true;
+}
+
+SDL_Surface* TextureCache::convert(SDL_Surface* source) const {
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(source, nativeFormat, 0);
+    if (!converted || !premultiply) return converted;
+
+    const SDL_PixelFormat* format = converted->format;
+    for (int y = 0; y < converted->h; ++y) {
+        Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(converted->pixels) + y * converted->pitch);
+        for (int x = 0; x < converted->w; ++x) {
+            Uint32 pixel = row[x];
+            Uint32 a = (pixel & format->Amask) >> format->Ashift;
+            if (a == 255) continue;
+            Uint32 r = ((pixel & format->Rmask) >> format->Rshift) * a / 255;
+            Uint32 g = ((pixel & format->Gmask) >> format->Gshift) * a / 255;
+            Uint32 b = ((pixel & format->Bmask) >> format->Bshift) * a / 255;
+            row[x] = (pixel & format->Amask) | (r << format->Rshift) | (g << format->Gshift) | (b << format->Bshift);
+        }
+    }
+    return converted;
+}
+
+void TextureCache::store(const std::string& name, Uint64 sourceHash, SDL_Surface* converted) const {
+    if (directory.empty() || !converted) return;
+    size_t rowBytes = static_cast<size_t>(converted->w) * 4;
+    std::vector<Uint8> packed(rowBytes * converted->h);
+    for (int y = 0; y < converted->h; ++y) {
+        memcpy(&packed[y * rowBytes], static_cast<Uint8*>(converted->pixels) + y * converted->pitch, rowBytes);
+    }
+    std::vector<Uint8> compressed(ZSTD_compressBound(packed.size()));
+    size_t size = ZSTD_compress(compressed.data(), compressed.size(), packed.data(), packed.size(), TEXTURE_CACHE_LEVEL);
+    if (ZSTD_isError(size)) return;
+
+    TextureCacheHeader header = {};
+    memcpy(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic));
+    header.version = TEXTURE_CACHE_VERSION;
+    header.sourceHash = sourceHash;
+    header.format = nativeFormat;
+    header.w = converted->w;
+    header.h = converted->h;
+    header.premultiplied = premultiply ? 1 : 0;
+    header.compressedSize = size;
+
+    std::string path = pathFor(name);
+    std::string temporary = path + ".tmp";
+    SDL_RWops* file = SDL_RWFromFile(temporary.c_str(), "wb");
+    if (!file) return;
+    bool ok = SDL_RWwrite(file, &header, sizeof(header), 1) == 1 && SDL_RWwrite(file, compressed.data(), 1, size) == size;
+    SDL_RWclose(file);
+    if (ok) {
+        remove(path.c_str());
+        ok = rename(temporary.c_str(), path.c_str()) == 0;
+    }
+    if (!ok) {
+        remove(temporary.c_str());
+    }
+}
+
+void TextureCache::applyBlendMode(SDL_Texture* texture, bool premultiplied) const {
+    SDL_SetTextureBlendMode(texture, premultiplied ? premultipliedBlend : SDL_BLENDMODE_BLEND);
+}
+
+// Cached art is uploaded once, so textures are static: streaming ones would
+// keep a CPU copy of every texture on the GL and D3D backends.
+SDL_Texture* TextureCache::createTexture(const CachedTexture& cached) const {
+    size_t rowBytes = static_cast<size_t>(cached.w) * 4;
+    std::vector<Uint8> pixels(rowBytes * cached.h);
+    size_t size = ZSTD_decompress(pixels.data(), pixels.size(), cached.compressed.data(), cached.compressed.size());
+    if (ZSTD_isError(size) || size != pixels.size()) return nullptr;
+
+    SDL_Texture* texture = SDL_CreateTexture(renderer, cached.format, SDL_TEXTUREACCESS_STATIC, cached.w, cached.h);
+    if (!texture) return nullptr;
+    if (SDL_UpdateTexture(texture, NULL, pixels.data(), static_cast<int>(rowBytes)) != 0) {
+        SDL_DestroyTexture(texture);
+        return nullptr;
+    }
+    applyBlendMode(texture, cached.premultiplied);
+    return texture;
+}
+
+SDL_Texture* TextureCache::createTexture(SDL_Surface* converted) const {
+    SDL_Texture* texture = SDL_CreateTexture(renderer, converted->format->format, SDL_TEXTUREACCESS_STATIC, converted->w, converted->h);
+    if (!texture) return nullptr;
+    if (SDL_UpdateTexture(texture, NULL, converted->pixels, converted->pitch) != 0) {
+        SDL_DestroyTexture(texture);
+        return nullptr;
+    }
+    applyBlendMode(texture, premultiply);
+    return texture;
+}
@@ -0,0 +1,79 @@
+#include "timer_wheel.h"
+#include <algorithm>
+
+void TimerWheel::init(int capacity) {
+    timers.resize(capacity);
+    clear();
+}
+
+void TimerWheel::clear() {
+    int count = static_cast<int>(timers.size());
+    for (int i = 0; i < count; ++i) {
+        timers[i].next = i + 1 < count ? i + 1 : -1;
+    }
+    freeList = count > 0 ? 0 : -1;
+    for (auto& level : slots) {
+        for (Slot& slot : level) {
+            slot = Slot();
+        }
+    }
+    pendingCount = 0;
+}
+
+bool TimerWheel::schedule(Uint32 delay, Callback callback, void* data) {
+    if (freeList < 0) return false;
+    int index = freeList;
+    freeList = timers[index].next;
+    delay = std::clamp(delay, 1u, TIMER_MAX_DELAY);
+    timers[index] = {current + delay, callback, data, -1};
+    insert(index);
+    ++pendingCount;
+    return true;
+}
+
+// The level is picked by how far away the timer is and the slot by when it
+// expires, so a slot never holds timers more than one lap of its level ahead.
+void TimerWheel::insert(int index) {
+    Timer& timer = timers[index];
+    Uint64 delta = timer.expires - current;
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (Uint64(1) << (TIMER_WHEEL_BITS * (level + 1)))) {
+        ++level;
+    }
+    Slot& slot = slots[level][(timer.expires >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1)];
+    timer.next = -1;
+    if (slot.tail >= 0) {
+        timers[slot.tail].next = index;
+    } else {
+        slot.head = index;
+    }
+    slot.tail = index;
+}
+
+int TimerWheel::take(int level, int slot) {
+    int head = slots[level][slot].head;
+    slots[level][slot] = Slot();
+    return head;
+}
+
+void TimerWheel::advance() {
+    ++current;
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; ++level) {
+        if (current & ((Uint64(1) << (TIMER_WHEEL_BITS * level)) - 1)) break;
+        int index = take(level, (current >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+        while (index >= 0) {
+            int next = timers[index].next;
+            insert(index);
+            index = next;
+        }
+    }
+    int index = take(0, current & (TIMER_WHEEL_SLOTS - 1));
+    while (index >= 0) {
+        Timer timer = timers[index];
+        timers[index].next = freeList;
+        freeList = index;
+        --pendingCount;
+        timer.callback(timer.data);
+        index = timer.next;
+    }
+}
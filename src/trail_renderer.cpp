@@ -0,0 +1,92 @@
+#include "trail_renderer.h"
+#include <algorithm>
+#include <cmath>
+
+TrailRenderer::TrailRenderer() {
+    for (int i = 0; i < TRAIL_MAX_SAMPLES - 1; ++i) {
+        int left = 2 * i;
+        indices[6 * i + 0] = left;
+        indices[6 * i + 1] = left + 1;
+        indices[6 * i + 2] = left + 2;
+        indices[6 * i + 3] = left + 1;
+        indices[6 * i + 4] = left + 3;
+        indices[6 * i + 5] = left + 2;
+    }
+}
+
+static float catmullRom(float p0, float p1, float p2, float p3, float t) {
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return 0.5f * (2 * p1 + (p2 - p0) * t + (2 * p0 - 5 * p1 + 4 * p2 - p3) * t2 + (3 * p1 - p0 - 3 * p2 + p3) * t3);
+}
+
+int TrailRenderer::buildSamples(const Trail& trail, int subdivisions) {
+    int count = trail.count;
+    const SDL_Point* points = trail.points.data();
+    subdivisions = std::min(subdivisions, TRAIL_SUBDIVISIONS);
+    if (subdivisions <= 1) {
+        for (int i = 0; i < count; ++i) {
+            samples[i] = {static_cast<float>(points[i].x), static_cast<float>(points[i].y)};
+        }
+        return count;
+    }
+    int n = 0;
+    for (int i = 0; i + 1 < count; ++i) {
+        const SDL_Point& p0 = points[std::max(i - 1, 0)];
+        const SDL_Point& p1 = points[i];
+        const SDL_Point& p2 = points[i + 1];
+        const SDL_Point& p3 = points[std::min(i + 2, count - 1)];
+        for (int k = 0; k < subdivisions; ++k) {
+            float t = static_cast<float>(k) / subdivisions;
+            samples[n++] = {catmullRom(p0.x, p1.x, p2.x, p3.x, t), catmullRom(p0.y, p1.y, p2.y, p3.y, t)};
+        }
+    }
+    if (count > 0) {
+        samples[n++] = {static_cast<float>(points[count - 1].x), static_cast<float>(points[count - 1].y)};
+    }
+    return n;
+}
+
+static SDL_FPoint segmentNormal(const SDL_FPoint& a, const SDL_FPoint& b) {
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    float len = std::sqrt(dx * dx + dy * dy);
+    if (len < 0.0001f) return {0, 0};
+    return {-dy / len, dx / len};
+}
+
+void TrailRenderer::render(SDL_Renderer* renderer, const Trail& trail, int subdivisions) {
+    int n = buildSamples(trail, subdivisions);
+    if (n < 2) return;
+
+    SDL_FPoint lastNormal = {0, 1};
+    for (int i = 0; i < n; ++i) {
+        SDL_FPoint in = i > 0 ? segmentNormal(samples[i - 1], samples[i]) : SDL_FPoint{0, 0};
+        SDL_FPoint out = i + 1 < n ? segmentNormal(samples[i], samples[i + 1]) : SDL_FPoint{0, 0};
+        SDL_FPoint miter = {in.x + out.x, in.y + out.y};
+        float miterLen = std::sqrt(miter.x * miter.x + miter.y * miter.y);
+        float scale = 1.0f;
+        if (miterLen < 0.0001f) {
+            miter = lastNormal;
+        } else {
+            miter = {miter.x / miterLen, miter.y / miterLen};
+            SDL_FPoint reference = (out.x != 0 || out.y != 0) ? out : in;
+            float cosine = miter.x * reference.x + miter.y * reference.y;
+            scale = std::min(1.0f / std::max(cosine, 0.0001f), 2.0f);
+            lastNormal = miter;
+        }
+
+        float t = static_cast<float>(i) / (n - 1);
+        float half = 0.5f * TRAIL_WIDTH * t * scale;
+        Uint8 alpha = static_cast<Uint8>(255 * t);
+        SDL_Color color = {230, 240, 255, alpha};
+        vertices[2 * i] = {{samples[i].x + miter.x * half, samples[i].y + miter.y * half}, color, {0, 0}};
+        vertices[2 * i + 1] = {{samples[i].x - miter.x * half, samples[i].y - miter.y * half}, color, {0, 0}};
+    }
+
+    SDL_BlendMode previous;
+    SDL_GetRenderDrawBlendMode(renderer, &previous);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_RenderGeometry(renderer, NULL, vertices.data(), 2 * n, indices.data(), 6 * (n - 1));
+    SDL_SetRenderDrawBlendMode(renderer, previous);
+}
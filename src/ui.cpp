@@ -0,0 +1,129 @@
+#include "ui.h"
+#include "game.h"
+
+bool createButton(SDL_Renderer* renderer, const Font& font, const char* label, int centerX, int y, Button& button) {
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* surface = font.renderSurface(label, white);
+    if (!surface) return false;
+    button.texture = SDL_CreateTextureFromSurface(renderer, surface);
+    int w = surface->w;
+    int h = surface->h;
+    SDL_FreeSurface(surface);
+    if (!button.texture) return false;
+
+    button.hitRect = {centerX - w / 2, y, w, h};
+    button.hoverRect.w = static_cast<int>(w * 0.9);
+    button.hoverRect.h = static_cast<int>(h * 0.9);
+    button.hoverRect.x = button.hitRect.x + (w - button.hoverRect.w) / 2;
+    button.hoverRect.y = button.hitRect.y + (h - button.hoverRect.h) / 2;
+    button.hovered = false;
+    return true;
+}
+
+bool runLoadingScreen(SDL_Renderer* renderer, AssetManager& assets, StartupProfile* profile) {
+    const SDL_Rect frame = {SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2 - 10, SCREEN_WIDTH / 2, 20};
+    bool firstFrame = true;
+    while (true) {
+        int total = assets.requestedCount();
+        int done = total - assets.pendingCount();
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderDrawRect(renderer, &frame);
+        SDL_Rect bar = {frame.x + 2, frame.y + 2, total > 0 ? (frame.w - 4) * done / total : frame.w - 4, frame.h - 4};
+        SDL_RenderFillRect(renderer, &bar);
+        Uint64 presentStart = profile ? profile->now() : 0;
+        SDL_RenderPresent(renderer);
+        if (profile && firstFrame) {
+            profile->record("first SDL_RenderPresent", presentStart);
+        }
+        firstFrame = false;
+        if (assets.pendingCount() == 0) {
+            return true;
+        }
+
+        SDL_Event e;
+        if (SDL_WaitEventTimeout(&e, 5)) {
+            do {
+                if (e.type == SDL_QUIT) return false;
+            } while (SDL_PollEvent(&e));
+        }
+        assets.pump(LOADING_BATCH);
+    }
+}
+
+void destroyButton(Button& button) {
+    SDL_DestroyTexture(button.texture);
+    button.texture = nullptr;
+}
+
+bool Menu::init(SDL_Renderer* renderer, const Font& font, const TextureHandle& background) {
+    this->renderer = renderer;
+    this->background = background;
+    bool ok = createButton(renderer, font, "Start", SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 50, start);
+    ok = createButton(renderer, font, "Exit", SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 50, exit) && ok;
+    int mouseX = 0, mouseY = 0;
+    SDL_GetMouseState(&mouseX, &mouseY);
+    updateHover(mouseX, mouseY);
+    dirty = true;
+    return ok;
+}
+
+void Menu::shutdown() {
+    destroyButton(start);
+    destroyButton(exit);
+    background.reset();
+}
+
+bool Menu::updateHover(int x, int y) {
+    bool startHovered = start.contains(x, y);
+    bool exitHovered = exit.contains(x, y);
+    bool changed = startHovered != start.hovered || exitHovered != exit.hovered;
+    start.hovered = startHovered;
+    exit.hovered = exitHovered;
+    return changed;
+}
+
+MenuAction Menu::handleEvent(const SDL_Event& e) {
+    switch (e.type) {
+    case SDL_MOUSEMOTION:
+        if (updateHover(e.motion.x, e.motion.y)) {
+            dirty = true;
+        }
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+        if (e.button.button == SDL_BUTTON_LEFT) {
+            if (start.contains(e.button.x, e.button.y)) return MENU_START;
+            if (exit.contains(e.button.x, e.button.y)) return MENU_EXIT;
+        }
+        break;
+    case SDL_WINDOWEVENT:
+        if (e.window.event == SDL_WINDOWEVENT_EXPOSED || e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+            e.window.event == SDL_WINDOWEVENT_RESTORED || e.window.event == SDL_WINDOWEVENT_SHOWN) {
+            dirty = true;
+        }
+        break;
+    case SDL_RENDER_TARGETS_RESET:
+    case SDL_RENDER_DEVICE_RESET:
+        dirty = true;
+        break;
+    }
+    return MENU_NONE;
+}
+
+void Menu::render() {
+    if (!dirty) return;
+    dirty = false;
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    if (SDL_Texture* texture = background.get()) {
+        SDL_RenderCopy(renderer, texture, NULL, NULL);
+    }
+    for (const Button* button : {&start, &exit}) {
+        if (button->texture) {
+            SDL_RenderCopy(renderer, button->texture, NULL, button->hovered ? &button->hoverRect : &button->hitRect);
+        }
+    }
+    SDL_RenderPresent(renderer);
+}
@@ -0,0 +1,183 @@
+// Bakes the game's fonts into a header that is compiled into the binary:
+//   bake_fonts <root> <output header>
+// Each font below is rendered once through SDL_ttf into an 8-bit coverage
+// atlas with its glyph metrics and kerning pairs, so the game can draw text
+// without initializing FreeType. Sizes not listed here fall back to TTF.
+#define SDL_MAIN_HANDLED
+#include "baked_font.h"
+#include <SDL2/SDL_ttf.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct BakeSpec {
+    const char* name;
+    int size;
+};
+
+const BakeSpec BAKE_SPECS[] = {
+    {"novem.ttf", 24},
+    {"PixelGame.otf", 24},
+};
+
+struct BakedOutput {
+    const BakeSpec* spec;
+    int height = 0;
+    int atlasHeight = 0;
+    std::vector<Uint8> atlas;
+    std::vector<BakedGlyph> glyphs;
+    std::vector<BakedKerning> kerning;
+};
+
+// Renders every glyph, crops it to its coverage and shelf-packs it into an
+// atlas BAKED_ATLAS_WIDTH pixels wide.
+static bool bake(const std::string& root, const BakeSpec& spec, BakedOutput& out) {
+    TTF_Font* font = TTF_OpenFont((root + "/" + spec.name).c_str(), spec.size);
+    if (!font) {
+        std::cout << "Failed to open " << spec.name << ": " << TTF_GetError() << std::endl;
+        return false;
+    }
+    out.spec = &spec;
+    out.height = TTF_FontHeight(font);
+
+    SDL_Color white = {255, 255, 255, 255};
+    int shelfX = 1, shelfY = 1, shelfHeight = 0;
+    for (int c = BAKED_FIRST_CHAR; c <= BAKED_LAST_CHAR; ++c) {
+        BakedGlyph glyph = {0, 0, 0, 0, 0, 0, 0};
+        int minX, maxX, minY, maxY, advance;
+        if (TTF_GlyphIsProvided32(font, c) && TTF_GlyphMetrics32(font, c, &minX, &maxX, &minY, &maxY, &advance) == 0) {
+            glyph.advance = static_cast<Sint16>(advance);
+        }
+        SDL_Surface* rendered = c == ' ' ? nullptr : TTF_RenderGlyph32_Blended(font, c, white);
+        SDL_Surface* surface = rendered ? SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0) : nullptr;
+        SDL_FreeSurface(rendered);
+        if (surface) {
+            int x0 = surface->w, y0 = surface->h, x1 = -1, y1 = -1;
+            for (int y = 0; y < surface->h; ++y) {
+                const Uint32* row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(surface->pixels) + y * surface->pitch);
+                for (int x = 0; x < surface->w; ++x) {
+                    if (row[x] >> 24) {
+                        x0 = std::min(x0, x);
+                        x1 = std::max(x1, x);
+                        y0 = std::min(y0, y);
+                        y1 = std::max(y1, y);
+                    }
+                }
+            }
+            if (x1 >= 0) {
+                int w = x1 - x0 + 1, h = y1 - y0 + 1;
+                if (shelfX + w + 1 > BAKED_ATLAS_WIDTH) {
+                    shelfX = 1;
+                    shelfY += shelfHeight + 1;
+                    shelfHeight = 0;
+                }
+                if (static_cast<int>(out.atlas.size()) < (shelfY + h + 1) * BAKED_ATLAS_WIDTH) {
+                    out.atlas.resize((shelfY + h + 1) * BAKED_ATLAS_WIDTH, 0);
+                }
+                for (int y = 0; y < h; ++y) {
+                    const Uint32* row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(surface->pixels) + (y0 + y) * surface->pitch);
+                    for (int x = 0; x < w; ++x) {
+                        out.atlas[(shelfY + y) * BAKED_ATLAS_WIDTH + shelfX + x] = static_cast<Uint8>(row[x0 + x] >> 24);
+                    }
+                }
+                glyph.x = static_cast<Sint16>(shelfX);
+                glyph.y = static_cast<Sint16>(shelfY);
+                glyph.w = static_cast<Sint16>(w);
+                glyph.h = static_cast<Sint16>(h);
+                glyph.offsetX = static_cast<Sint16>(x0);
+                glyph.offsetY = static_cast<Sint16>(y0);
+                shelfX += w + 1;
+                shelfHeight = std::max(shelfHeight, h);
+            }
+            SDL_FreeSurface(surface);
+        }
+        out.glyphs.push_back(glyph);
+    }
+    if (out.atlas.empty()) out.atlas.resize(BAKED_ATLAS_WIDTH, 0);
+    out.atlasHeight = static_cast<int>(out.atlas.size()) / BAKED_ATLAS_WIDTH;
+
+    for (int first = BAKED_FIRST_CHAR; first <= BAKED_LAST_CHAR; ++first) {
+        for (int second = BAKED_FIRST_CHAR; second <= BAKED_LAST_CHAR; ++second) {
+            int amount = TTF_GetFontKerningSizeGlyphs32(font, first, second);
+            if (amount != 0) {
+                out.kerning.push_back({static_cast<Uint8>(first), static_cast<Uint8>(second), static_cast<Sint8>(amount)});
+            }
+        }
+    }
+    TTF_CloseFont(font);
+    return true;
+}
+
+static void write(std::ofstream& file, const std::vector<BakedOutput>& fonts) {
+    file << "// Generated by tools/bake_fonts.cpp. Do not edit.\n"
+         << "#pragma once\n"
+         << "#include \"baked_font.h\"\n\n";
+    for (size_t i = 0; i < fonts.size(); ++i) {
+        const BakedOutput& font = fonts[i];
+        file << "// " << font.spec->name << " at " << font.spec->size << "pt\n";
+        file << "constexpr Uint8 BAKED_ATLAS_" << i << "[] = {";
+        for (size_t j = 0; j < font.atlas.size(); ++j) {
+            file << (j % 32 == 0 ? "\n    " : "") << static_cast<int>(font.atlas[j]) << ",";
+        }
+        file << "\n};\n";
+        file << "constexpr BakedGlyph BAKED_GLYPHS_" << i << "[BAKED_GLYPH_COUNT] = {\n";
+        for (const BakedGlyph& g : font.glyphs) {
+            file << "    {" << g.x << ", " << g.y << ", " << g.w << ", " << g.h << ", " << g.offsetX << ", " << g.offsetY << ", " << g.advance << "},\n";
+        }
+        file << "};\n";
+        // A zero-length array is not valid C++, so an unkerned font gets one unused entry.
+        file << "constexpr BakedKerning BAKED_KERNING_" << i << "[] = {\n";
+        for (const BakedKerning& k : font.kerning) {
+            file << "    {" << static_cast<int>(k.first) << ", " << static_cast<int>(k.second) << ", " << static_cast<int>(k.amount) << "},\n";
+        }
+        if (font.kerning.empty()) file << "    {0, 0, 0},\n";
+        file << "};\n\n";
+    }
+    file << "constexpr BakedFont BAKED_FONTS[] = {\n";
+    for (size_t i = 0; i < fonts.size(); ++i) {
+        const BakedOutput& font = fonts[i];
+        file << "    {\"" << font.spec->name << "\", " << font.spec->size << ", " << font.height << ", " << font.atlasHeight
+             << ", BAKED_ATLAS_" << i << ", BAKED_GLYPHS_" << i << ", BAKED_KERNING_" << i << ", " << font.kerning.size() << "},\n";
+    }
+    file << "};\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <root> <output header>" << std::endl;
+        return 1;
+    }
+    if (TTF_Init() != 0) {
+        std::cout << "Failed to initialize SDL_ttf: " << TTF_GetError() << std::endl;
+        return 1;
+    }
+    std::vector<BakedOutput> fonts;
+    for (const BakeSpec& spec : BAKE_SPECS) {
+        BakedOutput out;
+        if (!bake(argv[1], spec, out)) {
+            TTF_Quit();
+            return 1;
+        }
+        std::printf("%-16s %3dpt  atlas %dx%d  %zu kerning pairs\n", spec.name, spec.size, BAKED_ATLAS_WIDTH, out.atlasHeight, out.kerning.size());
+        fonts.push_back(std::move(out));
+    }
+    TTF_Quit();
+
+    std::string temporary = std::string(argv[2]) + ".tmp";
+    std::ofstream file(temporary, std::ios::trunc);
+    if (!file) {
+        std::cout << "Failed to write " << temporary << std::endl;
+        return 1;
+    }
+    write(file, fonts);
+    file.close();
+    std::remove(argv[2]);
+    if (std::rename(temporary.c_str(), argv[2]) != 0) {
+        std::cout << "Failed to write " << argv[2] << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Packs the game's assets into a single archive:
+//   pack <root> <output>
+// Every file in <root>/asset plus the fonts is stored under its path relative
+// to <root>. Entries are zstd-compressed only when that saves at least 10%,
+// so already-compressed images stay raw and can be read in place.
+#include "pack_format.h"
+#include <zstd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct InputFile {
+    std::string name;
+    std::vector<char> data;
+    std::vector<char> compressed;
+    bool useCompressed = false;
+};
+
+static bool readFile(const fs::path& path, std::vector<char>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <root> <output>" << std::endl;
+        return 1;
+    }
+    fs::path root = argv[1];
+    fs::path output = argv[2];
+
+    std::vector<fs::path> paths;
+    for (const auto& item : fs::directory_iterator(root / "asset")) {
+        if (item.is_regular_file()) paths.push_back(item.path());
+    }
+    paths.push_back(root / "novem.ttf");
+    paths.push_back(root / "PixelGame.otf");
+
+    std::vector<InputFile> files;
+    for (const fs::path& path : paths) {
+        InputFile input;
+        input.name = fs::relative(path, root).generic_string();
+        if (input.name.size() >= PACK_NAME_LENGTH) {
+            std::cout << "Name too long: " << input.name << std::endl;
+            return 1;
+        }
+        if (!readFile(path, input.data)) {
+            std::cout << "Failed to read " << path << std::endl;
+            return 1;
+        }
+        input.compressed.resize(ZSTD_compressBound(input.data.size()));
+        size_t size = ZSTD_compress(input.compressed.data(), input.compressed.size(), input.data.data(), input.data.size(), 19);
+        if (ZSTD_isError(size)) {
+            std::cout << "Failed to compress " << input.name << ": " << ZSTD_getErrorName(size) << std::endl;
+            return 1;
+        }
+        input.compressed.resize(size);
+        input.useCompressed = size * 10 < input.data.size() * 9;
+        files.push_back(std::move(input));
+    }
+    std::sort(files.begin(), files.end(), [](const InputFile& a, const InputFile& b) { return a.name < b.name; });
+
+    PackHeader header = {};
+    memcpy(header.magic, PACK_MAGIC, sizeof(header.magic));
+    header.version = PACK_VERSION;
+    header.entryCount = static_cast<uint32_t>(files.size());
+
+    std::vector<PackEntry> entries(files.size());
+    uint64_t offset = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+    for (size_t i = 0; i < files.size(); ++i) {
+        offset = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+        PackEntry& entry = entries[i];
+        strncpy(entry.name, files[i].name.c_str(), PACK_NAME_LENGTH - 1);
+        entry.offset = offset;
+        entry.rawSize = files[i].data.size();
+        entry.storedSize = files[i].useCompressed ? files[i].compressed.size() : files[i].data.size();
+        entry.flags = files[i].useCompressed ? PACK_FLAG_ZSTD : 0;
+        offset += entry.storedSize;
+    }
+
+    std::ofstream out(output, std::ios::binary);
+    if (!out) {
+        std::cout << "Failed to open " << output << std::endl;
+        return 1;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(PackEntry));
+    for (size_t i = 0; i < files.size(); ++i) {
+        while (static_cast<uint64_t>(out.tellp()) < entries[i].offset) {
+            out.put(0);
+        }
+        const std::vector<char>& data = files[i].useCompressed ? files[i].compressed : files[i].data;
+        out.write(data.data(), data.size());
+        std::printf("%-28s %9llu -> %9llu%s\n", entries[i].name, static_cast<unsigned long long>(entries[i].rawSize),
+                    static_cast<unsigned long long>(entries[i].storedSize), files[i].useCompressed ? " (zstd)" : "");
+    }
+    std::cout << "Wrote " << files.size() << " entries to " << output << std::endl;
+    return out ? 0 : 1;
+}